@@ -227,13 +227,55 @@ float3 ImportanceSample (float3 N)
        return (result.xyz / result.w);
 }
 
+// 1 convolves in the stretched texel directions of the cpu baker's warp seam
+// fixup (SeamFixupWarp in IblSeamFixup.h), so texels either side of a seam agree.
+// Whatever samples the results then has to undo the stretch. Keep the specular
+// and diffuse shaders in step.
+#ifndef IBL_WARP_EDGES
+#define IBL_WARP_EDGES 0
+#endif
+
+// Direction of the target texel under a pixel with the texel centres stretched
+// onto the face edges. D3D faces, as cubeDirection in IblCubeMap.cpp.
+float3 warpedTexelDirection(float2 pixel, uint face, uint mip)
+{
+    uint width, height, levels;
+    LastResult.GetDimensions(mip, width, height, levels);
+
+    float2 uv = float2(0.5, 0.5);
+    if (width > 1)
+        uv = floor(pixel) / (width - 1);
+
+    float sc = 2 * uv.x - 1;
+    float tc = 2 * uv.y - 1;
+    float3 direction;
+    if (face == 0)
+        direction = float3(1, -tc, -sc);
+    else if (face == 1)
+        direction = float3(-1, -tc, sc);
+    else if (face == 2)
+        direction = float3(sc, 1, tc);
+    else if (face == 3)
+        direction = float3(sc, -1, -tc);
+    else if (face == 4)
+        direction = float3(sc, -tc, 1);
+    else
+        direction = float3(-sc, -tc, -1);
+    return normalize(direction);
+}
+
 float4 PS_CubeMap( PS_CUBEMAP_IN input) : SV_Target
 {
     float3 R = input.Normal;
     float4 sampledColor = float4(0,0,0,1);
 
-    // Sample source cubemap at specified mip.
+    // Sample source cubemap at specified mip. The last result is read back at the
+    // texel centre either way.
+#if IBL_WARP_EDGES
+    float3 importanceSampled = ImportanceSample(warpedTexelDirection(input.Pos.xy, input.RTIndex, 0));
+#else
     float3 importanceSampled = ImportanceSample(R);
+#endif
 
     if (ConvolutionSamplesOffset > 1e-6)
     {
@@ -41,6 +41,13 @@
 
 #include <IblApplication.h>
 #include <IblApplicationHUD.h>
+#include <IblBakeServer.h>
+#include <IblAsyncLoader.h>
+#include <IblTextureCache.h>
+#include <IblEnvironmentDecoder.h>
+#include <IblMeshCache.h>
+#include <IblTrace.h>
+#include <IblPlatform.h>
 #include <CtrAssetManager.h>
 #include <CtrRenderDeviceD3D11.h>
 #include <CtrColorPass.h>
@@ -111,6 +118,18 @@ static const EnumTweakType DebugAOVType(&DebugAOVEnum[0], 9, "debugAOV");
 
 }
 
+ProbeBakeSettings::ProbeBakeSettings() :
+    hdrPixelFormat(PF_FLOAT32_RGBA),
+    sourceResolution(0),
+    specularResolution(0),
+    diffuseResolution(0),
+    sampleCount(0),
+    samplesPerFrame(0),
+    mipDrop(0),
+    environmentScale(1.0f)
+{
+}
+
 IBLApplication::IBLApplication(ApplicationHandle instance) : 
     Ctr::Application(instance),
     _colorPass(nullptr),
@@ -140,7 +159,24 @@ IBLApplication::IBLApplication(ApplicationHandle instance) :
     _debugTermProperty(new IntProperty(this, "Debug Visualization", new TweakFlags(&DebugAOVType, "Material"))),
     _defaultAsset("data\\meshes\\pistol\\pistol.obj"),
     _runTitles(false),
-    _inputMode(EquirectangularInput)
+    _inputMode(EquirectangularInput),
+    _bakeServer(nullptr),
+    _activeBakeJob(nullptr),
+    _activeBakeJobFrame(0),
+    _activeBakeJobSeconds(0),
+    _shaderBallEntity(nullptr),
+    _asyncLoader(nullptr),
+    _environmentLoadTask(0),
+    _textureCache(nullptr),
+    _textureCacheMegabytes(1024),
+    _sourceMemoryMegabytes(1024),
+    _startupTime(std::chrono::high_resolution_clock::now()),
+    _startupPhaseTime(_startupTime),
+    _frameBudgetMilliseconds(1000.0 / 60.0),
+    _lastInputTime(_startupTime),
+    _roughnessSchedule("linear"),
+    _bakeTraceBaking(false),
+    _bakeTraceComputed(false)
 {
     _modelVisualizationProperty->set(0);
     _visualizationSpaceProperty->set(Ctr::IBLApplication::HDR);
@@ -156,6 +192,11 @@ IBLApplication::IBLApplication(ApplicationHandle instance) :
 
 IBLApplication::~IBLApplication()
 {
+    // Joins the loader thread before anything it could hand back is destroyed.
+    safedelete(_asyncLoader);
+    safedelete(_textureCache);
+    safedelete(_bakeServer);
+    safedelete(_activeBakeJob);
     safedelete(_cameraManager);
     safedelete(_colorPass);
     safedelete(_iblRenderPass);
@@ -173,9 +214,29 @@ IBLApplication::parseOptions(int argc, char* argv[])
         if (std::string("--help") == argv[argId])
         {
             LOG ("IBLBaker: Specular and Irradiance cubemap baking tool")
+            LOG ("  --daemon <socket>  Stay resident and accept bake jobs on a local socket.")
+            LOG ("  --trace <dir>      Write a Chrome trace json per bake to dir.")
 
             return false;
         }
+        else if (std::string("--daemon") == argv[argId])
+        {
+            if (argId + 1 >= argc)
+            {
+                LOG ("--daemon requires a socket path");
+                return false;
+            }
+            _bakeSocketPathName = argv[++argId];
+        }
+        else if (std::string("--trace") == argv[argId])
+        {
+            if (argId + 1 >= argc)
+            {
+                LOG ("--trace requires a directory");
+                return false;
+            }
+            Trace::trace()->setDirectory(argv[++argId]);
+        }
     }
 
     return true;
@@ -199,6 +260,24 @@ IBLApplication::timer()
     return _timer;
 }
 
+AsyncLoader*
+IBLApplication::asyncLoader()
+{
+    return _asyncLoader;
+}
+
+bool
+IBLApplication::environmentLoading() const
+{
+    return _asyncLoader->pending(_environmentLoadTask);
+}
+
+void
+IBLApplication::cancelEnvironmentLoad()
+{
+    _asyncLoader->cancel(_environmentLoadTask);
+}
+
 IntProperty*
 IBLApplication::modelVisualizationProperty()
 {
@@ -256,13 +335,19 @@ IBLApplication::window()
 void
 IBLApplication::initialize()
 {
+    logStartupPhase("Application");
+    Trace::trace()->setThreadName("Main");
+
     DeviceD3D11* device = new DeviceD3D11();
     Ctr::ApplicationRenderParameters deviceParams(this, "IBLBaker", Ctr::Vector2i(_windowWidth, _windowHeight), _windowed, false);
 
     if (device->initialize(deviceParams))
     {
         _device = device;
+        logStartupPhase("Device");
+
         imguiCreate(_device);
+        logStartupPhase("Imgui");
 
         _mainWindow = _device->renderWindow();
 
@@ -272,19 +357,16 @@ IBLApplication::initialize()
         _cameraManager->create(_scene);
         _cameraManager->setTranslation(Ctr::Vector3f(0, -200, 0));
         _cameraManager->setRotation(Ctr::Vector3f(10, -15, -220));
+        _asyncLoader = new AsyncLoader();
+        _textureCache = new TextureCache(_device->textureMgr(), size_t(_textureCacheMegabytes) << 20);
+        logStartupPhase("Scene");
 
-        loadAsset(_visualizedEntity, _defaultAsset, "", true);
-
-        loadAsset(_shaderBallEntity, "data\\meshes\\shaderBall\\shaderBall.fbx", "", false);
-
-        _sphereEntity = _scene->load("data\\meshes\\sphere\\sphere.obj", 
-                                     "data\\meshes\\sphere\\sphere.material");
-        _sphereEntity->mesh(0)->scaleProperty()->set(Ctr::Vector3f(10,10,10));
-
-        _iblSphereEntity = _scene->load("data\\meshes\\sphere\\sphere.obj", 
+        // The ibl sphere is the bake source, everything else visual is created on first draw.
+        _iblSphereEntity = _scene->load(cachedMeshPathName("data\\meshes\\sphere\\sphere.obj"), 
                                         "data\\meshes\\sphere\\iblsphere.material");
 
         _iblSphereEntity->mesh(0)->scaleProperty()->set(Ctr::Vector3f(10,10,10));
+        logStartupPhase("Environment");
 
         // Initialize render passes
         _colorPass = new Ctr::ColorPass(_device);
@@ -292,9 +374,10 @@ IBLApplication::initialize()
 
         // Add a probe.
         _probe = _scene->addProbe();
-        // Default samples
+        // Default samples, samples per frame are then left to the frame budget.
         _probe->sampleCountProperty()->set(128);
         _probe->samplesPerFrameProperty()->set(128);
+        _frameBudget.setTargetMilliseconds(_frameBudgetMilliseconds, 100.0);
 
         _probe->hdrPixelFormatProperty()->set(_hdrFormatProperty->get()),
         _probe->sourceResolutionProperty()->set(_probeResolutionProperty->get());
@@ -303,17 +386,26 @@ IBLApplication::initialize()
         _probe->maxPixelRProperty()->set(maxPixelValue.x);
         _probe->maxPixelGProperty()->set(maxPixelValue.y);
         _probe->maxPixelBProperty()->set(maxPixelValue.z);
+        logStartupPhase("Probe");
 
-        // Good to go.
-        _renderHUD = new IBLApplicationHUD(this, _device, _inputMgr->inputState(), _scene);
-        _renderHUD->create();
-
+        if (!_bakeSocketPathName.empty())
         {
-            _renderHUD->setLogoVisible(true);
-            _renderHUD->logo()->setBlendIn(6.0f);
-            _renderHUD->showApplicationUI();
+            // The config and the defaults above, what every job starts from.
+            _bakeDefaults.hdrPixelFormat = _probe->hdrPixelFormatProperty()->get();
+            _bakeDefaults.sourceResolution = _probe->sourceResolutionProperty()->get();
+            _bakeDefaults.specularResolution = _probe->specularResolutionProperty()->get();
+            _bakeDefaults.diffuseResolution = _probe->diffuseResolutionProperty()->get();
+            _bakeDefaults.sampleCount = _probe->sampleCountProperty()->get();
+            _bakeDefaults.samplesPerFrame = _probe->samplesPerFrameProperty()->get();
+            _bakeDefaults.mipDrop = _probe->mipDropProperty()->get();
+            _bakeDefaults.environmentScale = _probe->environmentScaleProperty()->get();
+
+            _bakeServer = new BakeServer();
+            if (!_bakeServer->start(_bakeSocketPathName))
+            {
+                THROW ("Failed to start the bake server on " << _bakeSocketPathName);
+            }
         }
-        syncVisualization();
     }
     else
     {
@@ -322,6 +414,74 @@ IBLApplication::initialize()
     }
 }
 
+void
+IBLApplication::logStartupPhase(const char* phaseName)
+{
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    LOG ("Startup: " << phaseName << " " << 
+         std::chrono::duration<double, std::milli>(now - _startupPhaseTime).count() << "ms (" <<
+         std::chrono::duration<double, std::milli>(now - _startupTime).count() << "ms total)");
+    _startupPhaseTime = now;
+}
+
+bool
+IBLApplication::drawsViewport() const
+{
+    // Batch jobs only need the probe.
+    return _bakeServer == nullptr;
+}
+
+void
+IBLApplication::createVisualization()
+{
+    if (_sphereEntity)
+    {
+        return;
+    }
+
+    loadAsset(_shaderBallEntity, "data\\meshes\\shaderBall\\shaderBall.fbx", "", false);
+
+    _sphereEntity = _scene->load(cachedMeshPathName("data\\meshes\\sphere\\sphere.obj"), 
+                                 "data\\meshes\\sphere\\sphere.material");
+    _sphereEntity->mesh(0)->scaleProperty()->set(Ctr::Vector3f(10,10,10));
+
+    if (!_environmentPathName.empty())
+    {
+        syncEnvironmentSphere();
+    }
+    syncVisualization();
+    logStartupPhase("Visualization");
+
+    _renderHUD = new IBLApplicationHUD(this, _device, _inputMgr->inputState(), _scene);
+    _renderHUD->create();
+
+    {
+        _renderHUD->setLogoVisible(true);
+        _renderHUD->logo()->setBlendIn(6.0f);
+        _renderHUD->showApplicationUI();
+    }
+    logStartupPhase("HUD");
+
+    // The user asset is the slowest import, so it waits until a frame is on screen.
+    // The Assimp import and assbin export of a cache miss run on the loader thread.
+    // Scene::load creates the device buffers, so reading the assbin back stays on the
+    // main thread.
+    std::string assetPathName = _defaultAsset;
+    std::shared_ptr<std::string> meshPathName(new std::string());
+    _asyncLoader->submit("Loading " + assetPathName,
+        [assetPathName, meshPathName](AsyncLoadState&)
+        {
+            *meshPathName = cachedMeshPathName(assetPathName);
+            return true;
+        },
+        [this, assetPathName, meshPathName]()
+        {
+            loadCachedAsset(_visualizedEntity, assetPathName, *meshPathName, "", true);
+            syncVisualization();
+            logStartupPhase("User asset");
+        });
+}
+
 void
 IBLApplication::syncVisualization()
 {
@@ -332,6 +492,11 @@ IBLApplication::syncVisualization()
 void
 IBLApplication::setupModelVisibility(Ctr::Entity* entity, bool visibility)
 {
+    if (!entity)
+    {
+        return;
+    }
+
     const std::vector<Mesh*>& meshes = entity->meshes();
     for (auto meshIt = meshes.begin(); meshIt != meshes.end(); meshIt++)
     {
@@ -347,7 +512,9 @@ IBLApplication::run()
     // [MattD][Thermal] Turn on to save your gpu some needless processing.
     #define DO_NOT_FRY_GPU 1
     #if DO_NOT_FRY_GPU
-        _timer.setLockFrameCounter(60);
+        // The daemon is only ever waiting on the probe, let it run flat out.
+        if (!_bakeServer)
+            _timer.setLockFrameCounter(60);
     #endif
 
     do
@@ -357,22 +524,7 @@ IBLApplication::run()
         updateApplication();
 
     }
-    while (!purgeMessages());
-}
-
-bool 
-IBLApplication::purgeMessages() const
-{
-    MSG msg;
-    while(PeekMessage (&msg, 0, 0, 0, PM_REMOVE))
-    {
-        if(msg.message == WM_QUIT)
-            return true;
-
-        TranslateMessage(&msg);
-        DispatchMessage(&msg);
-    }
-    return false;
+    while (!pumpMessages());
 }
 
 bool
@@ -419,6 +571,39 @@ IBLApplication::loadParameters()
                 _probeResolutionProperty->set(atoi(xpathValue));
             }
 
+            if (const char* xpathValue = configNode.node().attribute("TextureCacheMB").value())
+            {
+                if (atoi(xpathValue) > 0)
+                {
+                    _textureCacheMegabytes = atoi(xpathValue);
+                }
+            }
+
+            if (const char* xpathValue = configNode.node().attribute("SourceMemoryMB").value())
+            {
+                if (atoi(xpathValue) > 0)
+                {
+                    _sourceMemoryMegabytes = atoi(xpathValue);
+                }
+            }
+
+            if (const char* xpathValue = configNode.node().attribute("FrameBudgetMS").value())
+            {
+                if (atof(xpathValue) > 0)
+                {
+                    _frameBudgetMilliseconds = atof(xpathValue);
+                }
+            }
+
+            if (pugi::xml_attribute attribute = configNode.node().attribute("RoughnessSchedule"))
+            {
+                _roughnessSchedule = attribute.value();
+            }
+            if (pugi::xml_attribute attribute = configNode.node().attribute("RoughnessTable"))
+            {
+                _roughnessTable = attribute.value();
+            }
+
             if (const char* xpathValue = configNode.node().attribute("SpecularWorkflow").value())
             {
                 std::string workflowValue(xpathValue);
@@ -467,6 +652,12 @@ IBLApplication::loadParameters()
 bool
 IBLApplication::saveParameters() const
 {
+    // Jobs override the probe settings, don't let them leak into the user's config.
+    if (_bakeServer)
+    {
+        return true;
+    }
+
     std::unique_ptr<pugi::xml_document> doc;
     doc.reset(new pugi::xml_document());
     if (doc)
@@ -487,32 +678,22 @@ IBLApplication::saveParameters() const
 
         configNode.append_attribute("DefaultAsset").set_value(_defaultAsset.c_str());
 
-        char buffer[512];
-        memset(buffer, 0, sizeof(char) * 512);
-        _itoa(window()->width(), buffer, 10);
-        configNode.append_attribute("WindowWidth").set_value(buffer);
-
-        memset(buffer, 0, sizeof(char) * 512);
-        _itoa(window()->height(), buffer, 10);
-        configNode.append_attribute("WindowHeight").set_value(buffer);
-
-        memset(buffer, 0, sizeof(char) * 512);
-        _itoa(window()->windowed() ? 1 : 0, buffer, 10);
-        configNode.append_attribute("Windowed").set_value(buffer);
-
-        memset(buffer, 0, sizeof(char) * 512);
-        _itoa(_runTitles ? 1 : 0, buffer, 10);
-        configNode.append_attribute("Titles").set_value(buffer);
+        configNode.append_attribute("WindowWidth").set_value(width);
+        configNode.append_attribute("WindowHeight").set_value(height);
+        configNode.append_attribute("Windowed").set_value(window()->windowed() ? 1 : 0);
+        configNode.append_attribute("Titles").set_value(_runTitles ? 1 : 0);
 
         int format = _scene->probes()[0]->hdrPixelFormat() == PF_FLOAT16_RGBA ? 16 : 32;
-        memset(buffer, 0, sizeof(char) * 512);
-        _itoa(format, buffer, 10);
-        configNode.append_attribute("IBLFormat").set_value(buffer);
-
-        memset(buffer, 0, sizeof(char) * 512);
-        _itoa(_scene->probes()[0]->sourceResolutionProperty()->get(), buffer, 10);
-        configNode.append_attribute("SourceEnvironmentResolution").set_value(buffer);
-
+        configNode.append_attribute("IBLFormat").set_value(format);
+        configNode.append_attribute("SourceEnvironmentResolution").set_value(_scene->probes()[0]->sourceResolutionProperty()->get());
+        configNode.append_attribute("TextureCacheMB").set_value(_textureCacheMegabytes);
+        configNode.append_attribute("SourceMemoryMB").set_value(_sourceMemoryMegabytes);
+        configNode.append_attribute("FrameBudgetMS").set_value(_frameBudgetMilliseconds);
+        configNode.append_attribute("RoughnessSchedule").set_value(_roughnessSchedule.c_str());
+        if (!_roughnessTable.empty())
+        {
+            configNode.append_attribute("RoughnessTable").set_value(_roughnessTable.c_str());
+        }
 
         std::string workflow("RoughnessMetal");
         switch (_specularWorkflowProperty->get())
@@ -542,25 +723,40 @@ IBLApplication::saveParameters() const
 void
 IBLApplication::updateApplication()
 {
+    // Frame work from here to present, without the wait for the frame lock.
+    std::chrono::high_resolution_clock::time_point frameStart = std::chrono::high_resolution_clock::now();
     float elapsedTime = (float)(_timer.elapsedTime());
+    _asyncLoader->update();
+
+    bool drawViewport = drawsViewport();
+    if (drawViewport)
+    {
+        createVisualization();
+    }
+
     _cameraManager->update(elapsedTime, true, true);
     _device->update();
     _scene->update();
-    _renderHUD->update(elapsedTime);
+    if (_renderHUD)
+    {
+        _renderHUD->update(elapsedTime);
+    }
 
-    Ctr::InputState* inputState = _inputMgr->input().inputState();
-    if (inputState->leftMouseDown() && !inputState->hasGUIFocus() && 
-        inputState->getKeyState(DIK_LCONTROL))
+    if (_bakeServer)
     {
-        Vector3f rotation;
-        Ctr::Entity* entity = visualizedEntity();
+        updateBakeJobs(elapsedTime);
+    }
+    updateBakeTrace();
 
-        if (modelVisualizationProperty()->get() == Ctr::IBLApplication::ShaderBallModel)
-            entity = _shaderBallEntity;
-        else
-            entity = _visualizedEntity;
+    Ctr::InputState* inputState = _inputMgr->input().inputState();
+    Ctr::Entity* entity = _visualizedEntity;
+    if (modelVisualizationProperty()->get() == Ctr::IBLApplication::ShaderBallModel)
+        entity = _shaderBallEntity;
 
-        rotation = entity->mesh(0)->rotation();
+    if (entity && inputState->leftMouseDown() && !inputState->hasGUIFocus() && 
+        inputState->getKeyState(DIK_LCONTROL))
+    {
+        Vector3f rotation = entity->mesh(0)->rotation();
 
         rotation += Ctr::Vector3f(((float)inputState->_y),((float)inputState->_x), 0);
         std::vector<Mesh*> meshes = entity->meshes();
@@ -568,7 +764,8 @@ IBLApplication::updateApplication()
             (*it)->rotationProperty()->set(rotation);
     }
 
-    if (_visualizationSpaceProperty->get() != _currentVisualizationSpaceProperty->get())
+    if (_visualizedEntity && 
+        _visualizationSpaceProperty->get() != _currentVisualizationSpaceProperty->get())
     {
         updateVisualizationType();
     }
@@ -582,23 +779,184 @@ IBLApplication::updateApplication()
     _device->bindFrameBuffer (_device->postEffectsMgr()->sceneFrameBuffer());
     _device->clearSurfaces (0, Ctr::CLEAR_TARGET | Ctr::CLEAR_ZBUFFER|Ctr::CLEAR_STENCIL, 
                                 clearColor.x, clearColor.y, clearColor.z, clearColor.w);
-    if (!_inputMgr->inputState()->leftMouseDown())
+    {
+        // Cpu side only, the device runs the convolution asynchronously. This carries
+        // on while the model or camera is dragged, the frame budget keeps the
+        // samples per frame down to what the viewport can afford.
+        IBL_TRACE_NAMED_SCOPE(convolveScope, _probe->computed() ? "IBL pass" : "Convolve", "bake");
+        IBL_TRACE_ARG(convolveScope, 0, "samplesPerFrame", _probe->samplesPerFrameProperty()->get());
+        IBL_TRACE_ARG(convolveScope, 1, "mips", _probe->specularCubeMap()->resource()->mipLevels());
         _iblRenderPass->render(_scene);
+    }
 
-
-     // Camera input.
-    _device->bindFrameBuffer(_device->postEffectsMgr()->sceneFrameBuffer());
+    if (drawViewport)
+    {
+        // Camera input.
+        _device->bindFrameBuffer(_device->postEffectsMgr()->sceneFrameBuffer());
     
-    _colorPass->render(_scene);
+        _colorPass->render(_scene);
 
-	 // Finalize post effects.
-    _device->postEffectsMgr()->render(camera);
+        // Finalize post effects.
+        _device->postEffectsMgr()->render(camera);
 
-    _device->bindFrameBuffer(_device->deviceFrameBuffer());
-    _renderHUD->render(camera);
+        _device->bindFrameBuffer(_device->deviceFrameBuffer());
+        _renderHUD->render(camera);
+    }
 
 	// Present to back buffre
     _device->present();
+
+    if (drawViewport)
+    {
+        updateFrameBudget(std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - frameStart).count());
+    }
+}
+
+void
+IBLApplication::updateFrameBudget(double workMilliseconds)
+{
+    std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    Ctr::InputState* inputState = _inputMgr->input().inputState();
+    if (inputState->_x != 0 || inputState->_y != 0 || inputState->leftMouseDown() || inputState->hasGUIFocus())
+    {
+        _lastInputTime = now;
+    }
+
+    // A couple of seconds without input, or another application in front, is idle.
+    bool interactive = Ctr::applicationHasFocus() &&
+                       std::chrono::duration<double>(now - _lastInputTime).count() < 2.0;
+    if (interactive != _frameBudget.interactive())
+    {
+        #if DO_NOT_FRY_GPU
+            // Zero unlocks, idle frames are paced by the idle target instead.
+            _timer.setLockFrameCounter(interactive ? 60 : 0);
+        #endif
+    }
+
+    // The probe goes to the full sample count in one frame if the budget allows.
+    _frameBudget.setSampleRange(8, std::max(_probe->sampleCountProperty()->get(), 8));
+    uint32_t samplesPerFrame = _frameBudget.update(_probe->computed() ? 0.0 : workMilliseconds, interactive);
+    if (int32_t(samplesPerFrame) != _probe->samplesPerFrameProperty()->get())
+    {
+        _probe->samplesPerFrameProperty()->set(samplesPerFrame);
+    }
+}
+
+void
+IBLApplication::resetBakeSettings()
+{
+    _probe->hdrPixelFormatProperty()->set(_bakeDefaults.hdrPixelFormat);
+    _probe->sourceResolutionProperty()->set(_bakeDefaults.sourceResolution);
+    _probe->specularResolutionProperty()->set(_bakeDefaults.specularResolution);
+    _probe->diffuseResolutionProperty()->set(_bakeDefaults.diffuseResolution);
+    _probe->sampleCountProperty()->set(_bakeDefaults.sampleCount);
+    _probe->samplesPerFrameProperty()->set(_bakeDefaults.samplesPerFrame);
+    _probe->mipDropProperty()->set(_bakeDefaults.mipDrop);
+    _probe->environmentScaleProperty()->set(_bakeDefaults.environmentScale);
+}
+
+bool
+IBLApplication::applyBakeSettings(const std::string& settingsPathName)
+{
+    if (std::unique_ptr<pugi::xml_document> doc =
+        std::unique_ptr<pugi::xml_document>(Ctr::AssetManager::assetManager()->openXmlDocument(settingsPathName)))
+    {
+        // Same attributes as iblBakerConfig.xml, plus the probe settings the HUD exposes.
+        pugi::xpath_node configNode = doc->select_single_node("/Config");
+        if (configNode)
+        {
+            pugi::xml_node node = configNode.node();
+            if (pugi::xml_attribute attribute = node.attribute("IBLFormat"))
+            {
+                _probe->hdrPixelFormatProperty()->set(attribute.as_int() == 16 ? PF_FLOAT16_RGBA : PF_FLOAT32_RGBA);
+            }
+            if (pugi::xml_attribute attribute = node.attribute("SourceEnvironmentResolution"))
+            {
+                _probe->sourceResolutionProperty()->set(attribute.as_int());
+            }
+            if (pugi::xml_attribute attribute = node.attribute("SpecularResolution"))
+            {
+                _probe->specularResolutionProperty()->set(attribute.as_int());
+            }
+            if (pugi::xml_attribute attribute = node.attribute("DiffuseResolution"))
+            {
+                _probe->diffuseResolutionProperty()->set(attribute.as_int());
+            }
+            if (pugi::xml_attribute attribute = node.attribute("SampleCount"))
+            {
+                _probe->sampleCountProperty()->set(attribute.as_int());
+                _probe->samplesPerFrameProperty()->set(attribute.as_int());
+            }
+            if (pugi::xml_attribute attribute = node.attribute("MipDrop"))
+            {
+                _probe->mipDropProperty()->set(attribute.as_int());
+            }
+            if (pugi::xml_attribute attribute = node.attribute("EnvironmentScale"))
+            {
+                _probe->environmentScaleProperty()->set(attribute.as_float());
+            }
+            return true;
+        }
+    }
+
+    LOG ("Could not read bake settings from " << settingsPathName);
+    return false;
+}
+
+void
+IBLApplication::updateBakeJobs(float elapsedTime)
+{
+    if (!_activeBakeJob)
+    {
+        BakeJob job;
+        if (!_bakeServer->popJob(job))
+        {
+            return;
+        }
+
+        _activeBakeJob = new BakeJob(job);
+        _activeBakeJobFrame = 0;
+        _activeBakeJobSeconds = 0;
+        _bakeServer->sendProgress(*_activeBakeJob, "Load", _activeBakeJobFrame);
+
+        // Settings files only name what they change, the rest comes from the defaults.
+        resetBakeSettings();
+        bool settingsApplied = _activeBakeJob->settingsPathName.empty() ||
+                               applyBakeSettings(_activeBakeJob->settingsPathName);
+
+        // Jobs own the frame, so float sources are decoded in place rather than on the loader.
+        AsyncLoadState loadState;
+        std::string environmentPathName = resolveEnvironment(_activeBakeJob->inputPathName,
+                                                             environmentDecodeSettings(),
+                                                             loadState);
+
+        // loadEnvironment uncaches the probe, which restarts the bake.
+        if (!settingsApplied || environmentPathName.empty() || !loadEnvironment(environmentPathName))
+        {
+            _bakeServer->sendDone(*_activeBakeJob, false, _activeBakeJobSeconds);
+            safedelete(_activeBakeJob);
+        }
+        return;
+    }
+
+    _activeBakeJobFrame++;
+    _activeBakeJobSeconds += elapsedTime;
+
+    if (!_probe->computed())
+    {
+        // Keep the client informed without flooding the socket every frame.
+        if (_activeBakeJobFrame % 30 == 0)
+        {
+            _bakeServer->sendProgress(*_activeBakeJob, "Bake", _activeBakeJobFrame);
+        }
+        return;
+    }
+
+    _bakeServer->sendProgress(*_activeBakeJob, "Save", _activeBakeJobFrame);
+    bool saved = saveImages(_activeBakeJob->outputPathName);
+    _bakeServer->sendDone(*_activeBakeJob, saved, _activeBakeJobSeconds);
+    safedelete(_activeBakeJob);
 }
 
 bool
@@ -607,56 +965,40 @@ IBLApplication::loadEnvironment(const std::string& filePathName)
     bool result = false; 
     if (AssetManager::fileExists(filePathName))
     {
-        // TODO: Reference counting.
-        _device->textureMgr()->recycle(_sphereEntity->mesh(0)->material()->albedoMap());
-        _sphereEntity->mesh(0)->material()->setAlbedoMap(filePathName);
+        beginBakeTrace(filePathName);
+        IBL_TRACE_SCOPE("Load environment", "load");
+
+        // Take the new reference before dropping the old one, the spheres can share a texture.
+        const ITexture* previousTexture = _iblSphereEntity->mesh(0)->material()->albedoMap();
+        _environmentPathName = filePathName;
+        _textureCache->acquire(filePathName);
         _iblSphereEntity->mesh(0)->material()->setAlbedoMap(filePathName);
 
         _scene->probes()[0]->uncache();
 
         // Is the environment a cubemap, if not, load up spherical versions of shaders.
-        if (const ITexture* texture = _sphereEntity->mesh(0)->material()->albedoMap())
+        if (const ITexture* texture = _iblSphereEntity->mesh(0)->material()->albedoMap())
         {
-            //texture->textureCount
             if (texture->isCubeMap())
             {
-                // Setup cubemap shaders.
-                _sphereEntity->mesh(0)->material()->setShaderName("EnvironmentSphere");
                 _iblSphereEntity->mesh(0)->material()->setShaderName("SinglePassEnvironment");
             }
             else
             {
-                // Setup spherical map shaders.
-                _sphereEntity->mesh(0)->material()->setShaderName("EnvironmentSphereSpherical");
                 _iblSphereEntity->mesh(0)->material()->setShaderName("SinglePassSphericalEnvironment");
             }
-
-
-            Ctr::PixelFormat format = texture->format();
-            float inputGamma = 1.0;
-            // Setup default gamma. 1.0 for HDR, 2.2 for LDR
-            if (format == Ctr::PF_FLOAT32_RGBA ||
-                format == Ctr::PF_FLOAT16_RGBA ||
-                format == Ctr::PF_FLOAT32_RGB ||
-                format == Ctr::PF_FLOAT16_GR ||
-                format == Ctr::PF_FLOAT32_GR ||
-                format == Ctr::PF_FLOAT32_R ||
-                format == Ctr::PF_FLOAT16_R)
-            {
-                 inputGamma = 1.0f;
-            }
-            else
-            {
-                 inputGamma = 2.2f;
-            }
-
             _iblSphereEntity->mesh(0)->material()->textureGammaProperty()->set(1.0f);
-            _sphereEntity->mesh(0)->material()->textureGammaProperty()->set(inputGamma);
+            result = true;
         }
 
-        _device->shaderMgr()->resolveShaders(_sphereEntity);
         _device->shaderMgr()->resolveShaders(_iblSphereEntity);
 
+        // The background sphere only exists once the viewport has been drawn.
+        if (_sphereEntity)
+        {
+            syncEnvironmentSphere();
+        }
+        _textureCache->release(previousTexture);
 
         Vector4f maxPixelValue = _iblSphereEntity->mesh(0)->material()->albedoMap()->maxValue();
         _probe->maxPixelRProperty()->set(maxPixelValue.x);
@@ -672,6 +1014,126 @@ IBLApplication::loadEnvironment(const std::string& filePathName)
     return result;
 }
 
+void
+IBLApplication::loadEnvironmentAsync(const std::string& filePathName)
+{
+    // Environments that are still resident swap in straight away.
+    EnvironmentDecodeSettings settings = environmentDecodeSettings();
+    std::string cachePathName = environmentCachePathName(filePathName, settings);
+    if (_textureCache->contains(cachePathName) || _textureCache->contains(filePathName))
+    {
+        loadEnvironment(_textureCache->contains(cachePathName) ? cachePathName : filePathName);
+        return;
+    }
+
+    // Float sources are decoded to a dds on the loader thread. The current environment 
+    // stays up until the main thread swaps the decoded one in.
+    beginBakeTrace(filePathName);
+    std::shared_ptr<std::string> texturePathName(new std::string(filePathName));
+    _environmentLoadTask = _asyncLoader->submit("Loading " + filePathName,
+        [filePathName, settings, texturePathName](AsyncLoadState& state)
+        {
+            *texturePathName = resolveEnvironment(filePathName, settings, state);
+            return !texturePathName->empty();
+        },
+        [this, texturePathName]()
+        {
+            loadEnvironment(*texturePathName);
+        });
+}
+
+void
+IBLApplication::beginBakeTrace(const std::string& environmentPathName)
+{
+    // Loading and decoding belong to the bake they lead to, so a capture that has
+    // not finished baking yet keeps going.
+    if (Trace::trace()->capturing() && !_bakeTraceComputed)
+    {
+        return;
+    }
+
+    size_t nameStart = environmentPathName.find_last_of("/\\");
+    nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+    std::string captureName = environmentPathName.substr(nameStart, environmentPathName.rfind('.') - nameStart);
+
+    Trace::trace()->begin(captureName.empty() ? std::string("bake") : captureName);
+    _bakeTraceBaking = false;
+    _bakeTraceComputed = false;
+}
+
+void
+IBLApplication::updateBakeTrace()
+{
+    if (!Trace::trace()->capturing() || _bakeTraceComputed)
+    {
+        return;
+    }
+
+    if (!_probe->computed())
+    {
+        _bakeTraceBaking = true;
+    }
+    else if (_bakeTraceBaking)
+    {
+        // The capture stays open for saveImages, totals so far cover the bake.
+        _bakeTraceComputed = true;
+        Trace::trace()->logTotals("bake");
+    }
+}
+
+EnvironmentDecodeSettings
+IBLApplication::environmentDecodeSettings() const
+{
+    EnvironmentDecodeSettings settings;
+    settings.cubeResolution = _probe->sourceResolutionProperty()->get();
+    settings.memoryBudget = size_t(_sourceMemoryMegabytes) << 20;
+    return settings;
+}
+
+void
+IBLApplication::syncEnvironmentSphere()
+{
+    const ITexture* previousTexture = _sphereEntity->mesh(0)->material()->albedoMap();
+    _textureCache->acquire(_environmentPathName);
+    _sphereEntity->mesh(0)->material()->setAlbedoMap(_environmentPathName);
+    _textureCache->release(previousTexture);
+
+    if (const ITexture* texture = _sphereEntity->mesh(0)->material()->albedoMap())
+    {
+        // Setup cubemap or spherical map shaders.
+        if (texture->isCubeMap())
+        {
+            _sphereEntity->mesh(0)->material()->setShaderName("EnvironmentSphere");
+        }
+        else
+        {
+            _sphereEntity->mesh(0)->material()->setShaderName("EnvironmentSphereSpherical");
+        }
+
+        Ctr::PixelFormat format = texture->format();
+        float inputGamma = 1.0;
+        // Setup default gamma. 1.0 for HDR, 2.2 for LDR
+        if (format == Ctr::PF_FLOAT32_RGBA ||
+            format == Ctr::PF_FLOAT16_RGBA ||
+            format == Ctr::PF_FLOAT32_RGB ||
+            format == Ctr::PF_FLOAT16_GR ||
+            format == Ctr::PF_FLOAT32_GR ||
+            format == Ctr::PF_FLOAT32_R ||
+            format == Ctr::PF_FLOAT16_R)
+        {
+             inputGamma = 1.0f;
+        }
+        else
+        {
+             inputGamma = 2.2f;
+        }
+
+        _sphereEntity->mesh(0)->material()->textureGammaProperty()->set(inputGamma);
+    }
+
+    _device->shaderMgr()->resolveShaders(_sphereEntity);
+}
+
 bool
 IBLApplication::saveImages(const std::string& filePathName, bool gameOnly)
 {
@@ -715,29 +1177,53 @@ IBLApplication::saveImages(const std::string& filePathName, bool gameOnly)
 
             std::string brdfLUTPath = pathName + fileNameBase + "Brdf.dds";
 
+            // Each save covers the seam fix, encode and write for one file.
             LOG("Saving RGBM MDR diffuse to " << diffuseMDRPath);
-            probe->diffuseCubeMapMDR()->save(diffuseMDRPath, true /* fix seams */, false /* split to RGB MMM */);
+            {
+                IBL_TRACE_SCOPE("Save diffuse MDR", "save");
+                probe->diffuseCubeMapMDR()->save(diffuseMDRPath, true /* fix seams */, false /* split to RGB MMM */);
+            }
             LOG("Saving RGBM MDR specular to " << specularMDRPath);
-            probe->specularCubeMapMDR()->save(specularMDRPath, true /* fix seams */, false /* split to RGB MMM */);
+            {
+                IBL_TRACE_SCOPE("Save specular MDR", "save");
+                probe->specularCubeMapMDR()->save(specularMDRPath, true /* fix seams */, false /* split to RGB MMM */);
+            }
             LOG("Saving RGBM MDR environment to " << envMDRPath);
-            probe->environmentCubeMapMDR()->save(envMDRPath, true /* fix seams */, false /* split to RGB MMM */);
+            {
+                IBL_TRACE_SCOPE("Save environment MDR", "save");
+                probe->environmentCubeMapMDR()->save(envMDRPath, true /* fix seams */, false /* split to RGB MMM */);
+            }
 
 
             // Save the brdf too.
-            _scene->activeBrdf()->brdfLut()->save(brdfLUTPath, false, false);
+            {
+                IBL_TRACE_SCOPE("Save brdf LUT", "save");
+                _scene->activeBrdf()->brdfLut()->save(brdfLUTPath, false, false);
+            }
 
 
 // This operation on a 2k floating point cubemap with a full mip chain blows
 // through remaining addressable memory on 32bit.
 #if _64BIT
-            probe->environmentCubeMap()->save(envHDRPath, true, false);
+            {
+                IBL_TRACE_SCOPE("Save environment HDR", "save");
+                probe->environmentCubeMap()->save(envHDRPath, true, false);
+            }
 #endif
             LOG ("Saving HDR diffuse to " << diffuseHDRPath);
-            probe->diffuseCubeMap()->save(diffuseHDRPath, true, false);
+            {
+                IBL_TRACE_SCOPE("Save diffuse HDR", "save");
+                probe->diffuseCubeMap()->save(diffuseHDRPath, true, false);
+            }
 
             LOG ("Saving HDR specular to " << specularHDRPath);
-            probe->specularCubeMap()->save(specularHDRPath, true, false);
+            {
+                IBL_TRACE_SCOPE("Save specular HDR", "save");
+                probe->specularCubeMap()->save(specularHDRPath, true, false);
+            }
 
+            // The capture ends once the bake's images are out.
+            Trace::trace()->end();
             return true;
         }
     }
@@ -748,6 +1234,8 @@ IBLApplication::saveImages(const std::string& filePathName, bool gameOnly)
 void
 IBLApplication::compute()
 {
+    beginBakeTrace(_environmentPathName);
+
     if (Ctr::IBLProbe* probe = _scene->probes()[0])
     {
         if (probe->computed())
@@ -827,13 +1315,23 @@ IBLApplication::loadAsset(Entity*& targetEntity,
                        const std::string& materialPathName,
                        bool userAsset)
 {
+    loadCachedAsset(targetEntity, assetPathName, cachedMeshPathName(assetPathName), materialPathName, userAsset);
+}
 
+void
+IBLApplication::loadCachedAsset(Entity*& targetEntity,
+                                const std::string& assetPathName,
+                                const std::string& meshPathName,
+                                const std::string& materialPathName,
+                                bool userAsset)
+{
     if (targetEntity && userAsset)
     {
         _scene->destroy(targetEntity);
     }
 
-    targetEntity = _scene->load(assetPathName, materialPathName);
+    targetEntity = _scene->load(meshPathName, 
+                                cachedMeshMaterialPathName(assetPathName, materialPathName));
     //if (userAsset)
     { 
         const std::vector<Mesh*>& meshes = targetEntity->meshes();
@@ -49,6 +49,8 @@
 #include <CtrTypedProperty.h>
 #include <CtrMaterial.h>
 #include <CtrApplication.h>
+#include <IblFrameBudget.h>
+#include <chrono>
 
 namespace Ctr
 {
@@ -69,6 +71,27 @@ class RenderHUD;
 class IBLProbe;
 class Entity;
 class Titles;
+class BakeServer;
+struct BakeJob;
+class AsyncLoader;
+class TextureCache;
+struct EnvironmentDecodeSettings;
+
+// The probe settings a daemon job's settings file can change. Every job starts
+// from the ones the daemon started with, so a job does not inherit the last one's.
+struct ProbeBakeSettings
+{
+    ProbeBakeSettings();
+
+    PixelFormat                hdrPixelFormat;
+    int32_t                    sourceResolution;
+    int32_t                    specularResolution;
+    int32_t                    diffuseResolution;
+    int32_t                    sampleCount;
+    int32_t                    samplesPerFrame;
+    int32_t                    mipDrop;
+    float                      environmentScale;
+};
 
 class IBLApplication : public Ctr::Application
 { 
@@ -91,13 +114,28 @@ class IBLApplication : public Ctr::Application
     bool                       loadParameters();
     bool                       saveParameters() const;
 
+    void                       resetBakeSettings();
+    bool                       applyBakeSettings(const std::string& settingsPathName);
     bool                       loadEnvironment(const std::string& filePathName);
+    void                       loadEnvironmentAsync(const std::string& filePathName);
     bool                       saveImages(const std::string& filePathName, bool gameOnly = false);
 
     void                       loadAsset(Entity*& targetEntity,
                                          const std::string& assetPathName,
                                          const std::string& materialPathName,
                                          bool  userAsset);
+    // loadAsset with the mesh cachedMeshPathName already returned for the asset, so
+    // the import can be done off the main thread.
+    void                       loadCachedAsset(Entity*& targetEntity,
+                                               const std::string& assetPathName,
+                                               const std::string& meshPathName,
+                                               const std::string& materialPathName,
+                                               bool  userAsset);
+
+    AsyncLoader*               asyncLoader();
+    // The environment load from loadEnvironmentAsync, other loads are left running.
+    bool                       environmentLoading() const;
+    void                       cancelEnvironmentLoad();
 
     IntProperty*               modelVisualizationProperty();
     FloatProperty*             constantRoughnessProperty();
@@ -148,8 +186,17 @@ class IBLApplication : public Ctr::Application
 
   protected:
     void                       updateApplication();
-    bool                       purgeMessages() const;
     void                       updateVisualizationType();
+    void                       updateBakeJobs(float elapsedTime);
+    void                       updateFrameBudget(double workMilliseconds);
+
+    bool                       drawsViewport() const;
+    void                       createVisualization();
+    void                       syncEnvironmentSphere();
+    EnvironmentDecodeSettings  environmentDecodeSettings() const;
+    void                       logStartupPhase(const char* phaseName);
+    void                       beginBakeTrace(const std::string& environmentPathName);
+    void                       updateBakeTrace();
 
   private:
     // Properties:
@@ -199,6 +246,39 @@ class IBLApplication : public Ctr::Application
     IntProperty*                _debugTermProperty;
 
     SourceInputMode             _inputMode;
+
+    // Daemon mode. Set from --daemon <socket>.
+    std::string                 _bakeSocketPathName;
+    BakeServer*                 _bakeServer;
+    BakeJob*                    _activeBakeJob;
+    uint32_t                    _activeBakeJobFrame;
+    double                      _activeBakeJobSeconds;
+    ProbeBakeSettings           _bakeDefaults;
+
+    // Lazy start-up.
+    std::string                 _environmentPathName;
+    AsyncLoader*                _asyncLoader;
+    uint64_t                    _environmentLoadTask;
+    TextureCache*               _textureCache;
+    uint32_t                    _textureCacheMegabytes;
+    uint32_t                    _sourceMemoryMegabytes;
+    std::chrono::high_resolution_clock::time_point _startupTime;
+    std::chrono::high_resolution_clock::time_point _startupPhaseTime;
+
+    // Interactive samples per frame, see FrameBudget.
+    FrameBudget                 _frameBudget;
+    double                      _frameBudgetMilliseconds;
+    std::chrono::high_resolution_clock::time_point _lastInputTime;
+
+    // RoughnessSchedule and RoughnessTable of iblBakerConfig.xml, for iblbaker_cli
+    // --config. The probe bakes the linear schedule, they are kept so saving the
+    // config does not drop them.
+    std::string                 _roughnessSchedule;
+    std::string                 _roughnessTable;
+
+    // Tracing.
+    bool                        _bakeTraceBaking;
+    bool                        _bakeTraceComputed;
 };
 }
 
@@ -41,6 +41,7 @@
 
 #include <IblApplicationHUD.h>
 #include <IblApplication.h>
+#include <IblAsyncLoader.h>
 #include <CtrCamera.h>
 #include <CtrScene.h>
 #include <CtrEntity.h>
@@ -55,6 +56,7 @@
 #include <CtrTextureMgr.h>
 #include <Ctrimgui.h>
 #include <CommDlg.h>
+#include <sstream>
 
 namespace Ctr
 {
@@ -420,7 +422,19 @@ IBLApplicationHUD::render(const Ctr::Camera* camera)
                 std::wstring inputString(selectedFilePathName);
                 std::string  filePathName(inputString.begin(), inputString.end());
 
-                _iblApplication->loadEnvironment(std::string(filePathName.c_str()));
+                _iblApplication->loadEnvironmentAsync(std::string(filePathName.c_str()));
+            }
+        }
+        if (_iblApplication->asyncLoader()->busy())
+        {
+            std::ostringstream loadStatus;
+            loadStatus << _iblApplication->asyncLoader()->description() << " " 
+                       << int(_iblApplication->asyncLoader()->progress() * 100.0f) << "%";
+            imguiLabel(loadStatus.str().c_str());
+            // Only the environment, the user asset queued at start-up keeps loading.
+            if (_iblApplication->environmentLoading() && imguiButton("Cancel Load"))
+            {
+                _iblApplication->cancelEnvironmentLoad();
             }
         }
         if (imguiButton("Save Environment"))
@@ -460,8 +474,13 @@ IBLApplicationHUD::render(const Ctr::Camera* camera)
             imguiUnindent();
         }
 
-        imguiRegionBorder("Rendering:", NULL, _showRendering, _renderingEnabled);
-        if (_showRendering)
+        Ctr::Entity* entity = _iblApplication->visualizedEntity();
+        if (_iblApplication->modelVisualizationProperty()->get() == Ctr::IBLApplication::ShaderBallModel)
+            entity = _iblApplication->shaderBallEntity();
+
+        // The user asset is loaded after the first frame has been presented.
+        imguiRegionBorder("Rendering:", NULL, _showRendering, _renderingEnabled && entity != nullptr);
+        if (_showRendering && entity)
         {
             imguiIndent();
             imguiPropertySlider("Exposure", _scene->camera()->exposureProperty(), 0.0f, 10.0f, 0.01f);
@@ -470,10 +489,6 @@ IBLApplicationHUD::render(const Ctr::Camera* camera)
             imguiSelectionSliderForEnumProperty("View Model", _iblApplication->modelVisualizationProperty());
             _iblApplication->syncVisualization();
 
-            Ctr::Entity* entity = _iblApplication->visualizedEntity();
-            if (_iblApplication->modelVisualizationProperty()->get() == Ctr::IBLApplication::ShaderBallModel)
-                entity = _iblApplication->shaderBallEntity();
-
 
 
             std::vector<Ctr::IntProperty*> debugTermProperties;
@@ -564,13 +579,8 @@ IBLApplicationHUD::render(const Ctr::Camera* camera)
             imguiPropertiesSlider("Input Gamma", &inputGammas[0], 2, 0.0f, 5.0f, 0.01f);
             imguiPropertySlider("Environment Scale", _scene->probes()[0]->environmentScaleProperty(), 0.0f, 10.0f, 0.1f);
 
-            // Lock sample counts for now.
-            IntProperty* inputSamples[2] = {
-                _scene->probes()[0]->sampleCountProperty(),
-                _scene->probes()[0]->samplesPerFrameProperty()
-            };
-
-            imguiPropertiesSlider("Sample Count", &inputSamples[0], 2, 0.0f, 2048.0f, 1);
+            // Samples per frame follow the frame budget.
+            imguiPropertySlider("Sample Count", _scene->probes()[0]->sampleCountProperty(), 0.0f, 2048.0f, 1);
             imguiPropertySlider("Mip Drop", _scene->probes()[0]->mipDropProperty(), 0.0f, _scene->probes()[0]->specularCubeMap()->resource()->mipLevels() - 1.0f, 1);
             imguiPropertySlider("Saturation", _scene->probes()[0]->iblSaturationProperty(), 0.0f, 1.0f, 0.05f);
             //imguiPropertySlider("Contrast", _scene->probes()[0]->iblContrastProperty(), 0.0f, 1.0f, 0.05f);
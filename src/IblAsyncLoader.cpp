@@ -0,0 +1,230 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblAsyncLoader.h>
+#include <IblTrace.h>
+#include <algorithm>
+
+namespace Ctr
+{
+AsyncLoadState::AsyncLoadState() :
+    _cancelled(false),
+    _progress(0.0f)
+{
+}
+
+bool
+AsyncLoadState::cancelled() const
+{
+    return _cancelled;
+}
+
+void
+AsyncLoadState::cancel()
+{
+    _cancelled = true;
+}
+
+float
+AsyncLoadState::progress() const
+{
+    return _progress;
+}
+
+void
+AsyncLoadState::setProgress(float progress)
+{
+    _progress = progress;
+}
+
+AsyncLoader::AsyncLoader() :
+    _running(true),
+    _nextTaskId(1)
+{
+    _worker = std::thread(&AsyncLoader::run, this);
+}
+
+AsyncLoader::~AsyncLoader()
+{
+    cancel();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+    }
+    _wake.notify_all();
+    _worker.join();
+}
+
+AsyncLoader::TaskId
+AsyncLoader::submit(const std::string& description,
+                    WorkFunction work,
+                    FinalizeFunction finalize)
+{
+    Task task;
+    task.id = 0;
+    task.description = description;
+    task.work = work;
+    task.finalize = finalize;
+    task.state.reset(new AsyncLoadState());
+    task.succeeded = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        task.id = _nextTaskId++;
+        _pending.push_back(task);
+    }
+    _wake.notify_one();
+    return task.id;
+}
+
+void
+AsyncLoader::update()
+{
+    std::deque<Task> completed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        completed.swap(_completed);
+    }
+
+    for (auto taskIt = completed.begin(); taskIt != completed.end(); taskIt++)
+    {
+        if (taskIt->state->cancelled())
+        {
+            LOG ("Cancelled " << taskIt->description);
+        }
+        else if (!taskIt->succeeded)
+        {
+            LOG ("Failed " << taskIt->description);
+        }
+        else if (taskIt->finalize)
+        {
+            taskIt->finalize();
+        }
+    }
+}
+
+void
+AsyncLoader::cancel()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto taskIt = _pending.begin(); taskIt != _pending.end(); taskIt++)
+        taskIt->state->cancel();
+    if (_active)
+        _active->state->cancel();
+}
+
+void
+AsyncLoader::cancel(TaskId taskId)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto taskIt = _pending.begin(); taskIt != _pending.end(); taskIt++)
+    {
+        if (taskIt->id == taskId)
+            taskIt->state->cancel();
+    }
+    if (_active && _active->id == taskId)
+        _active->state->cancel();
+}
+
+bool
+AsyncLoader::busy() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _active || !_pending.empty() || !_completed.empty();
+}
+
+bool
+AsyncLoader::pending(TaskId taskId) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto matches = [taskId](const Task& task) { return task.id == taskId; };
+    return (_active && _active->id == taskId) ||
+           std::find_if(_pending.begin(), _pending.end(), matches) != _pending.end() ||
+           std::find_if(_completed.begin(), _completed.end(), matches) != _completed.end();
+}
+
+std::string
+AsyncLoader::description() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_active)
+        return _active->description;
+    if (!_pending.empty())
+        return _pending.front().description;
+    return std::string();
+}
+
+float
+AsyncLoader::progress() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _active ? _active->state->progress() : 0.0f;
+}
+
+void
+AsyncLoader::run()
+{
+    Trace::trace()->setThreadName("Loader");
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake.wait(lock, [this]() { return !_running || !_pending.empty(); });
+            if (!_running)
+                return;
+
+            _active.reset(new Task(_pending.front()));
+            _pending.pop_front();
+        }
+
+        Task& task = *_active;
+        if (!task.state->cancelled())
+        {
+            task.succeeded = task.work(*task.state);
+        }
+        task.state->setProgress(1.0f);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _completed.push_back(task);
+        _active.reset();
+    }
+}
+}
@@ -0,0 +1,135 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_ASYNC_LOADER
+#define INCLUDED_IBL_ASYNC_LOADER
+
+#include <IblPlatform.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Shared between a load task's worker function and the main thread.                 //
+//------------------------------------------------------------------------------------//
+class AsyncLoadState
+{
+  public:
+    AsyncLoadState();
+
+    bool                       cancelled() const;
+    void                       cancel();
+
+    float                      progress() const;
+    void                       setProgress(float progress);
+
+  private:
+    std::atomic<bool>          _cancelled;
+    std::atomic<float>         _progress;
+};
+
+//------------------------------------------------------------------------------------//
+// Runs the slow part of a load (decode, conversion) on a worker thread and hands     //
+// the result back to the main thread, which does the device side creation from      //
+// update(). Tasks run in submission order.                                           //
+//------------------------------------------------------------------------------------//
+class AsyncLoader
+{
+  public:
+    // Worker thread. Returns false on failure or cancellation.
+    typedef std::function<bool (AsyncLoadState&)> WorkFunction;
+    // Main thread. Only called for tasks that succeeded and were not cancelled.
+    typedef std::function<void ()> FinalizeFunction;
+    // Names a submitted task, 0 is never used.
+    typedef uint64_t TaskId;
+
+    AsyncLoader();
+    ~AsyncLoader();
+
+    TaskId                     submit(const std::string& description,
+                                      WorkFunction work,
+                                      FinalizeFunction finalize);
+
+    // Main thread, once a frame.
+    void                       update();
+
+    // Cancels everything queued or in flight.
+    void                       cancel();
+    // Cancels one task if it is still queued or in flight, leaving the others be.
+    void                       cancel(TaskId taskId);
+
+    bool                       busy() const;
+    // Whether a task is queued, in flight or waiting to be finalized.
+    bool                       pending(TaskId taskId) const;
+    std::string                description() const;
+    float                      progress() const;
+
+  private:
+    struct Task
+    {
+        TaskId                 id;
+        std::string            description;
+        WorkFunction           work;
+        FinalizeFunction       finalize;
+        std::shared_ptr<AsyncLoadState> state;
+        bool                   succeeded;
+    };
+
+    void                       run();
+
+    std::thread                _worker;
+    mutable std::mutex         _mutex;
+    std::condition_variable    _wake;
+    bool                       _running;
+    TaskId                     _nextTaskId;
+
+    std::deque<Task>           _pending;
+    std::deque<Task>           _completed;
+    std::unique_ptr<Task>      _active;
+};
+}
+
+#endif
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblBackgroundBake.h>
+#include <algorithm>
+
+namespace Ctr
+{
+BackgroundBake::BackgroundBake() :
+    _hasPublished(false),
+    _failed(false),
+    _generation(0)
+{
+}
+
+BackgroundBake::~BackgroundBake()
+{
+    cancel();
+}
+
+bool
+BackgroundBake::start(const BakeContext& context, uint32_t firstSampleCount)
+{
+    if (!context.hasSource())
+    {
+        return false;
+    }
+
+    uint32_t generation;
+    _loader.cancel();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        generation = ++_generation;
+        _hasPublished = false;
+        _failed = false;
+    }
+
+    std::shared_ptr<BakeContext> work(new BakeContext(context));
+    _loader.submit("background bake", [this, work, firstSampleCount, generation](AsyncLoadState& state)
+    {
+        return refine(*work, firstSampleCount, generation, state);
+    }, nullptr);
+    return true;
+}
+
+void
+BackgroundBake::cancel()
+{
+    _loader.cancel();
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_generation;
+    _hasPublished = false;
+}
+
+bool
+BackgroundBake::acquire(BakeContext& target)
+{
+    // Retires finished and cancelled bakes.
+    _loader.update();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_hasPublished)
+    {
+        return false;
+    }
+    target.copyResults(_published);
+    _hasPublished = false;
+    return true;
+}
+
+bool
+BackgroundBake::busy() const
+{
+    if (_loader.busy())
+    {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _hasPublished;
+}
+
+bool
+BackgroundBake::failed() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _failed;
+}
+
+bool
+BackgroundBake::refine(BakeContext& work, uint32_t firstSampleCount, uint32_t generation, AsyncLoadState& state)
+{
+    uint32_t sampleCount = work.settings().sampleCount;
+    // A zero sample count goes through to bake, which refuses it.
+    uint32_t passSampleCount = std::min(std::max(firstSampleCount, 1u), sampleCount);
+    for (;;)
+    {
+        work.settings().sampleCount = passSampleCount;
+        bool baked = work.bake();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (state.cancelled() || generation != _generation)
+        {
+            return false;
+        }
+        if (!baked)
+        {
+            _failed = true;
+            return false;
+        }
+        _published.copyResults(work);
+        _hasPublished = true;
+        state.setProgress(float(passSampleCount) / float(sampleCount));
+
+        if (passSampleCount >= sampleCount)
+        {
+            return true;
+        }
+        passSampleCount = std::min(passSampleCount * 2, sampleCount);
+    }
+}
+}
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_BACKGROUND_BAKE
+#define INCLUDED_IBL_BACKGROUND_BAKE
+
+#include <IblPlatform.h>
+#include <IblAsyncLoader.h>
+#include <IblBakeContext.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Progressive cpu bake on a worker thread, for viewports that must keep drawing      //
+// while the probe refines. The worker bakes a copy of the context in passes. The     //
+// first pass uses firstSampleCount samples, and each later pass doubles that up to   //
+// the context's sampleCount. A finished pass is published to a buffer of its own,    //
+// and the viewport takes the newest one with acquire whenever it likes. The worker   //
+// never writes results that are being read. Only the convolutions are redone between //
+// passes, see BakeContext::staleStages.                                              //
+//------------------------------------------------------------------------------------//
+class BackgroundBake
+{
+  public:
+    BackgroundBake();
+    ~BackgroundBake();
+
+    // Copies the source and settings of context and starts refining them. A bake
+    // already running is cancelled and its passes are no longer published.
+    bool                       start(const BakeContext& context, uint32_t firstSampleCount = 64);
+    // Cancels after the pass in flight.
+    void                       cancel();
+
+    // Copies the newest pass into target. Returns false if nothing has been published
+    // since the last call.
+    bool                       acquire(BakeContext& target);
+
+    // True until the last pass of the bake has been acquired or the bake is cancelled.
+    bool                       busy() const;
+    // True if a pass of the current bake failed, see BakeContext::bake.
+    bool                       failed() const;
+
+  private:
+    bool                       refine(BakeContext& work,
+                                      uint32_t firstSampleCount,
+                                      uint32_t generation,
+                                      AsyncLoadState& state);
+
+    mutable std::mutex         _mutex;
+    BakeContext                _published;
+    bool                       _hasPublished;
+    bool                       _failed;
+    uint32_t                   _generation;
+    // Last, so the worker is joined before anything it publishes to goes.
+    AsyncLoader                _loader;
+};
+}
+
+#endif
@@ -0,0 +1,503 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblBake.h>
+#include <IblBakeContext.h>
+#include <IblBackgroundBake.h>
+
+using namespace Ctr;
+
+static_assert(int(IBL_BAKE_SEAMS_NONE) == int(SeamFixupNone) &&
+              int(IBL_BAKE_SEAMS_AVERAGE) == int(SeamFixupAverage) &&
+              int(IBL_BAKE_SEAMS_WARP) == int(SeamFixupWarp), "IblBakeSeamFixup has to match SeamFixup");
+
+struct IblBakeContext
+{
+    BakeContext                context;
+    // Created by the first iblBakeStart.
+    std::unique_ptr<BackgroundBake> background;
+};
+
+namespace
+{
+const CubeMap*
+outputCube(const IblBakeContext* context, IblBakeOutput output)
+{
+    switch (output)
+    {
+        case IBL_BAKE_ENVIRONMENT: return context->context.hasSource() ? &context->context.environment() : nullptr;
+        case IBL_BAKE_SPECULAR: return context->context.baked() ? &context->context.specular() : nullptr;
+        case IBL_BAKE_DIFFUSE: return context->context.baked() ? &context->context.diffuse() : nullptr;
+        default: return nullptr;
+    }
+}
+}
+
+// Nothing may throw across the C boundary. Allocation failures on big sources are
+// the likely case.
+#define IBL_BAKE_CATCH(result) \
+    catch (const std::exception& exception) { LOG ("iblbake: " << exception.what()); return result; }
+
+IblBakeContext*
+iblBakeCreateContext(void)
+{
+    try
+    {
+        return new IblBakeContext();
+    }
+    IBL_BAKE_CATCH(nullptr)
+}
+
+void
+iblBakeDestroyContext(IblBakeContext* context)
+{
+    delete context;
+}
+
+IblBakeResult
+iblBakeSetParameter(IblBakeContext* context, IblBakeParameter parameter, uint32_t value)
+{
+    if (!context)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+
+    BakeSettings& settings = context->context.settings();
+    switch (parameter)
+    {
+        case IBL_BAKE_SOURCE_RESOLUTION: settings.sourceResolution = value; break;
+        case IBL_BAKE_SPECULAR_RESOLUTION: settings.specularResolution = value; break;
+        case IBL_BAKE_DIFFUSE_RESOLUTION: settings.diffuseResolution = value; break;
+        case IBL_BAKE_SAMPLE_COUNT:
+            if (value == 0)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.sampleCount = value;
+            break;
+        case IBL_BAKE_MIP_DROP: settings.mipDrop = value; break;
+        case IBL_BAKE_BRDF_RESOLUTION: settings.lutSize = value; break;
+        case IBL_BAKE_BRDF_SAMPLE_COUNT:
+            if (value == 0)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.lutSampleCount = value;
+            break;
+        case IBL_BAKE_HDR_FORMAT:
+            if (value != 16 && value != 32)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.format = value == 16 ? DdsRgba16f : DdsRgba32f;
+            break;
+        case IBL_BAKE_SOURCE_MEMORY: settings.memoryBudget = size_t(value) << 20; break;
+        case IBL_BAKE_SEAM_FIXUP:
+            if (value > IBL_BAKE_SEAMS_WARP)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.seamFixup = SeamFixup(value);
+            break;
+        case IBL_BAKE_BRDF_MODEL:
+            if (value > IBL_BAKE_BRDF_SCHLICK)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.convolution.brdf = BrdfModel(value);
+            break;
+        case IBL_BAKE_BRDF_FORMAT:
+        {
+            const DdsFormat formats[] = { DdsRgba32f, DdsRgba16f, DdsRg32f, DdsRg16f, DdsRg16 };
+            if (value > IBL_BAKE_BRDF_RG16_UNORM)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.lutFormat = formats[value];
+            break;
+        }
+        case IBL_BAKE_BRDF_MULTISCATTER: settings.lutMultiScatter = value != 0; break;
+        case IBL_BAKE_ROUGHNESS_CURVE:
+            if (value > IBL_BAKE_ROUGHNESS_UNREAL)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            settings.convolution.roughnessSchedule.curve = RoughnessCurve(value);
+            settings.convolution.roughnessSchedule.table.clear();
+            break;
+        default: return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    return IBL_BAKE_OK;
+}
+
+IblBakeResult
+iblBakeSetFloatParameter(IblBakeContext* context, IblBakeFloatParameter parameter, float value)
+{
+    if (!context || value != value || (parameter == IBL_BAKE_SH_ROUGHNESS && value <= 0.0f))
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+
+    ConvolutionSettings& convolution = context->context.settings().convolution;
+    switch (parameter)
+    {
+        case IBL_BAKE_ENVIRONMENT_SCALE: convolution.environmentScale = value; break;
+        case IBL_BAKE_SATURATION: convolution.saturation = value; break;
+        case IBL_BAKE_HUE: convolution.hue = value; break;
+        case IBL_BAKE_SH_ROUGHNESS: convolution.shRoughness = value; break;
+        default: return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    return IBL_BAKE_OK;
+}
+
+IblBakeResult
+iblBakeSetRoughnessTable(IblBakeContext* context, const float* roughness, uint32_t count)
+{
+    if (!context || !roughness || count == 0)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    for (uint32_t entry = 0; entry < count; entry++)
+    {
+        if (!(roughness[entry] >= 0.0f && roughness[entry] <= 1.0f) ||
+            (entry > 0 && roughness[entry] < roughness[entry - 1]))
+        {
+            return IBL_BAKE_INVALID_ARGUMENT;
+        }
+    }
+
+    RoughnessSchedule& schedule = context->context.settings().convolution.roughnessSchedule;
+    schedule.curve = RoughnessTable;
+    schedule.table.assign(roughness, roughness + count);
+    return IBL_BAKE_OK;
+}
+
+IblBakeResult
+iblBakeSetSourceFile(IblBakeContext* context, const char* filePathName)
+{
+    if (!context || !filePathName)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        return context->context.setSource(filePathName) ? IBL_BAKE_OK : IBL_BAKE_SOURCE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_SOURCE_FAILED)
+}
+
+IblBakeResult
+iblBakeSetSourceEquirect(IblBakeContext* context, const float* rgba, uint32_t width, uint32_t height)
+{
+    if (!context || !rgba || width == 0 || height == 0)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        return context->context.setSourceEquirect(rgba, width, height) ? IBL_BAKE_OK : IBL_BAKE_SOURCE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_SOURCE_FAILED)
+}
+
+IblBakeResult
+iblBakeSetSourceCube(IblBakeContext* context, const float* rgba, uint32_t size)
+{
+    if (!context || !rgba || size == 0)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        return context->context.setSourceCube(rgba, size) ? IBL_BAKE_OK : IBL_BAKE_SOURCE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_SOURCE_FAILED)
+}
+
+IblBakeResult
+iblBakeRun(IblBakeContext* context)
+{
+    if (!context)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    if (!context->context.hasSource())
+    {
+        return IBL_BAKE_NO_SOURCE;
+    }
+
+    try
+    {
+        iblBakeStop(context);
+        return context->context.bake() ? IBL_BAKE_OK : IBL_BAKE_BAKE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_BAKE_FAILED)
+}
+
+IblBakeResult
+iblBakeStart(IblBakeContext* context)
+{
+    if (!context)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    if (!context->context.hasSource())
+    {
+        return IBL_BAKE_NO_SOURCE;
+    }
+
+    try
+    {
+        if (!context->background)
+        {
+            context->background.reset(new BackgroundBake());
+        }
+        return context->background->start(context->context) ? IBL_BAKE_OK : IBL_BAKE_BAKE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_BAKE_FAILED)
+}
+
+IblBakeResult
+iblBakeUpdate(IblBakeContext* context, uint32_t* sampleCount, uint32_t* running)
+{
+    if (sampleCount)
+    {
+        *sampleCount = 0;
+    }
+    if (running)
+    {
+        *running = 0;
+    }
+    if (!context)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        BackgroundBake* background = context->background.get();
+        if (background)
+        {
+            background->acquire(context->context);
+        }
+        if (sampleCount && context->context.baked())
+        {
+            *sampleCount = context->context.bakedSettings().sampleCount;
+        }
+        if (running && background)
+        {
+            *running = background->busy() ? 1 : 0;
+        }
+        return background && background->failed() ? IBL_BAKE_BAKE_FAILED : IBL_BAKE_OK;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_BAKE_FAILED)
+}
+
+void
+iblBakeStop(IblBakeContext* context)
+{
+    if (context && context->background)
+    {
+        context->background->cancel();
+    }
+}
+
+uint32_t
+iblBakeGetMipCount(const IblBakeContext* context, IblBakeOutput output)
+{
+    if (!context)
+    {
+        return 0;
+    }
+    if (output == IBL_BAKE_BRDF)
+    {
+        return context->context.baked() ? 1 : 0;
+    }
+
+    const CubeMap* cubeMap = outputCube(context, output);
+    return cubeMap ? cubeMap->mipCount() : 0;
+}
+
+const float*
+iblBakeGetSurface(const IblBakeContext* context, IblBakeOutput output, uint32_t face, uint32_t mip, uint32_t* size)
+{
+    if (size)
+    {
+        *size = 0;
+    }
+    if (!context)
+    {
+        return nullptr;
+    }
+
+    if (output == IBL_BAKE_BRDF)
+    {
+        if (!context->context.baked() || face != 0 || mip != 0)
+        {
+            return nullptr;
+        }
+        if (size)
+        {
+            *size = context->context.brdfLutSize();
+        }
+        return context->context.brdfLut();
+    }
+
+    const CubeMap* cubeMap = outputCube(context, output);
+    if (!cubeMap || face >= 6 || mip >= cubeMap->mipCount())
+    {
+        return nullptr;
+    }
+    if (size)
+    {
+        *size = cubeMap->mipSize(mip);
+    }
+    return cubeMap->texels(face, mip);
+}
+
+float
+iblBakeGetMipRoughness(const IblBakeContext* context, uint32_t mip)
+{
+    if (!context)
+    {
+        return -1.0f;
+    }
+
+    const CubeMap* cubeMap = outputCube(context, IBL_BAKE_SPECULAR);
+    if (!cubeMap || mip >= cubeMap->mipRoughness().size())
+    {
+        return -1.0f;
+    }
+    return cubeMap->mipRoughness()[mip];
+}
+
+IblBakeResult
+iblBakeWriteFiles(const IblBakeContext* context, const char* basePathName)
+{
+    if (!context || !basePathName)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    if (!context->context.baked())
+    {
+        return IBL_BAKE_NOT_BAKED;
+    }
+
+    try
+    {
+        return context->context.save(basePathName) ? IBL_BAKE_OK : IBL_BAKE_WRITE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_WRITE_FAILED)
+}
+
+IblBakeResult
+iblBakeWriteBundle(const IblBakeContext* context, const char* filePathName)
+{
+    if (!context || !filePathName)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    if (!context->context.baked())
+    {
+        return IBL_BAKE_NOT_BAKED;
+    }
+
+    try
+    {
+        return context->context.saveBundle(filePathName) ? IBL_BAKE_OK : IBL_BAKE_WRITE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_WRITE_FAILED)
+}
+
+IblBakeResult
+iblBakeWriteTargets(const IblBakeContext* context,
+                    const char* basePathName,
+                    const IblBakeTarget* targets,
+                    uint32_t targetCount)
+{
+    if (!context || !basePathName || !targets || targetCount == 0)
+    {
+        return IBL_BAKE_INVALID_ARGUMENT;
+    }
+    if (!context->context.baked())
+    {
+        return IBL_BAKE_NOT_BAKED;
+    }
+
+    try
+    {
+        std::vector<ExportTarget> exportTargets(targetCount);
+        for (uint32_t targetId = 0; targetId < targetCount; targetId++)
+        {
+            const IblBakeTarget& target = targets[targetId];
+            if (!target.name || uint32_t(target.encoding) > IBL_BAKE_ENCODING_RGBD)
+            {
+                return IBL_BAKE_INVALID_ARGUMENT;
+            }
+            exportTargets[targetId].name = target.name;
+            exportTargets[targetId].specularResolution = target.specularResolution;
+            exportTargets[targetId].diffuseResolution = target.diffuseResolution;
+            exportTargets[targetId].encoding = ExportEncoding(target.encoding);
+        }
+        return context->context.exportTargets(basePathName, exportTargets) ? IBL_BAKE_OK : IBL_BAKE_WRITE_FAILED;
+    }
+    IBL_BAKE_CATCH(IBL_BAKE_WRITE_FAILED)
+}
+
+const char*
+iblBakeResultString(IblBakeResult result)
+{
+    switch (result)
+    {
+        case IBL_BAKE_OK: return "ok";
+        case IBL_BAKE_INVALID_ARGUMENT: return "invalid argument";
+        case IBL_BAKE_SOURCE_FAILED: return "the source could not be loaded";
+        case IBL_BAKE_NO_SOURCE: return "no source has been set";
+        case IBL_BAKE_BAKE_FAILED: return "the bake failed";
+        case IBL_BAKE_NOT_BAKED: return "the context has not been baked";
+        case IBL_BAKE_WRITE_FAILED: return "the outputs could not be written";
+        default: return "unknown result";
+    }
+}
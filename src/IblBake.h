@@ -0,0 +1,280 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_BAKE
+#define INCLUDED_IBL_BAKE
+
+//------------------------------------------------------------------------------------//
+// C API of the iblbake library, for baking in process from C, C++ or anything with   //
+// a C FFI (ctypes, cffi). A context holds one source and the outputs of its last     //
+// bake. Contexts are independent, use one per thread. Each bake already runs on all  //
+// cores.                                                                             //
+//                                                                                    //
+//   IblBakeContext* context = iblBakeCreateContext();                                //
+//   iblBakeSetParameter(context, IBL_BAKE_SPECULAR_RESOLUTION, 128);                 //
+//   iblBakeSetSourceEquirect(context, texels, width, height);                        //
+//   iblBakeRun(context);                                                             //
+//   const float* mip = iblBakeGetSurface(context, IBL_BAKE_SPECULAR, 0, 2, &size);   //
+//   iblBakeDestroyContext(context);                                                  //
+//------------------------------------------------------------------------------------//
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(IBL_BAKE_SHARED)
+#if defined(IBL_BAKE_EXPORTS)
+#define IBL_BAKE_API __declspec(dllexport)
+#else
+#define IBL_BAKE_API __declspec(dllimport)
+#endif
+#else
+#define IBL_BAKE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct IblBakeContext IblBakeContext;
+
+typedef enum IblBakeResult
+{
+    IBL_BAKE_OK = 0,
+    IBL_BAKE_INVALID_ARGUMENT,
+    IBL_BAKE_SOURCE_FAILED,
+    IBL_BAKE_NO_SOURCE,
+    IBL_BAKE_BAKE_FAILED,
+    IBL_BAKE_NOT_BAKED,
+    IBL_BAKE_WRITE_FAILED
+} IblBakeResult;
+
+// Integer parameters. The source resolution and memory are used when a source is
+// set, the rest when baking. Defaults are those of iblbaker_cli.
+typedef enum IblBakeParameter
+{
+    IBL_BAKE_SOURCE_RESOLUTION = 0,
+    IBL_BAKE_SPECULAR_RESOLUTION,
+    IBL_BAKE_DIFFUSE_RESOLUTION,
+    // At least 1, as is IBL_BAKE_BRDF_SAMPLE_COUNT.
+    IBL_BAKE_SAMPLE_COUNT,
+    IBL_BAKE_MIP_DROP,
+    IBL_BAKE_BRDF_RESOLUTION,
+    IBL_BAKE_BRDF_SAMPLE_COUNT,
+    // 16 or 32, bits per channel of the HDR files written by iblBakeWriteFiles.
+    IBL_BAKE_HDR_FORMAT,
+    // Megabytes held at once while resampling an equirect source.
+    IBL_BAKE_SOURCE_MEMORY,
+    // One of IblBakeSeamFixup, default IBL_BAKE_SEAMS_AVERAGE.
+    IBL_BAKE_SEAM_FIXUP,
+    // One of IblBakeBrdfModel, default IBL_BAKE_BRDF_SMITH.
+    IBL_BAKE_BRDF_MODEL,
+    // One of IblBakeBrdfFormat, the format of the LUT iblBakeWriteFiles writes,
+    // default IBL_BAKE_BRDF_RGBA32F.
+    IBL_BAKE_BRDF_FORMAT,
+    // 1 to bake the multiple scattering average albedo into the third channel of
+    // the LUT instead of the roughness. Needs a four channel IBL_BAKE_BRDF_FORMAT.
+    IBL_BAKE_BRDF_MULTISCATTER,
+    // One of IblBakeRoughnessCurve, default IBL_BAKE_ROUGHNESS_LINEAR.
+    IBL_BAKE_ROUGHNESS_CURVE
+} IblBakeParameter;
+
+// See IblSeamFixup.h. With warp, readers have to undo the stretch when sampling.
+typedef enum IblBakeSeamFixup
+{
+    IBL_BAKE_SEAMS_NONE = 0,
+    IBL_BAKE_SEAMS_AVERAGE,
+    IBL_BAKE_SEAMS_WARP
+} IblBakeSeamFixup;
+
+// The .brdf file the LUT and the specular lods are computed for, see IblBrdf.h.
+typedef enum IblBakeBrdfModel
+{
+    IBL_BAKE_BRDF_SMITH = 0,
+    IBL_BAKE_BRDF_SCHLICK
+} IblBakeBrdfModel;
+
+// The two channel formats hold scale and bias only.
+typedef enum IblBakeBrdfFormat
+{
+    IBL_BAKE_BRDF_RGBA32F = 0,
+    IBL_BAKE_BRDF_RGBA16F,
+    IBL_BAKE_BRDF_RG32F,
+    IBL_BAKE_BRDF_RG16F,
+    IBL_BAKE_BRDF_RG16_UNORM
+} IblBakeBrdfFormat;
+
+// The roughness each specular mip is baked with, to match the roughness to lod curve
+// of the engine that samples the chain. See IblRoughnessSchedule.h.
+typedef enum IblBakeRoughnessCurve
+{
+    IBL_BAKE_ROUGHNESS_LINEAR = 0,
+    IBL_BAKE_ROUGHNESS_SQRT,
+    IBL_BAKE_ROUGHNESS_UNREAL
+} IblBakeRoughnessCurve;
+
+typedef enum IblBakeFloatParameter
+{
+    IBL_BAKE_ENVIRONMENT_SCALE = 0,
+    IBL_BAKE_SATURATION,
+    IBL_BAKE_HUE,
+    // Specular mips from this roughness up are baked from an SH projection of the
+    // source instead of by sampling, default 0.6. Above 1 turns it off. Mips under
+    // 0.5 are always sampled, the SH lobe is over 1% off in luminance there. Must
+    // be above 0.
+    IBL_BAKE_SH_ROUGHNESS
+} IblBakeFloatParameter;
+
+typedef enum IblBakeOutput
+{
+    // The source as a cube with a full mip chain.
+    IBL_BAKE_ENVIRONMENT = 0,
+    IBL_BAKE_SPECULAR,
+    IBL_BAKE_DIFFUSE,
+    // 2D, one face and one mip, RGBA32F whatever IBL_BAKE_BRDF_FORMAT is: scale,
+    // bias, roughness (or the average albedo, see IBL_BAKE_BRDF_MULTISCATTER), 1.
+    IBL_BAKE_BRDF
+} IblBakeOutput;
+
+// How iblBakeWriteTargets encodes the cubes of a target.
+typedef enum IblBakeEncoding
+{
+    IBL_BAKE_ENCODING_HDR16 = 0,
+    IBL_BAKE_ENCODING_HDR32,
+    IBL_BAKE_ENCODING_RGBM,
+    IBL_BAKE_ENCODING_RGBD
+} IblBakeEncoding;
+
+// One set of output files, e.g. one per platform.
+typedef struct IblBakeTarget
+{
+    const char*                name;
+    uint32_t                   specularResolution;
+    uint32_t                   diffuseResolution;
+    IblBakeEncoding            encoding;
+} IblBakeTarget;
+
+IBL_BAKE_API IblBakeContext*   iblBakeCreateContext(void);
+IBL_BAKE_API void              iblBakeDestroyContext(IblBakeContext* context);
+
+IBL_BAKE_API IblBakeResult     iblBakeSetParameter(IblBakeContext* context,
+                                                   IblBakeParameter parameter,
+                                                   uint32_t value);
+IBL_BAKE_API IblBakeResult     iblBakeSetFloatParameter(IblBakeContext* context,
+                                                        IblBakeFloatParameter parameter,
+                                                        float value);
+// Bakes the specular mips with roughness read off a table instead of a curve, count
+// values in [0, 1] that never decrease, spread evenly from the first mip to the last.
+// Setting IBL_BAKE_ROUGHNESS_CURVE goes back to a curve.
+IBL_BAKE_API IblBakeResult     iblBakeSetRoughnessTable(IblBakeContext* context,
+                                                        const float* roughness,
+                                                        uint32_t count);
+
+// .hdr or .dds: float equirects, float cubes and RGBM cubes.
+IBL_BAKE_API IblBakeResult     iblBakeSetSourceFile(IblBakeContext* context,
+                                                    const char* filePathName);
+// RGBA32F, width * height texels, top row first. Not kept after the call returns.
+IBL_BAKE_API IblBakeResult     iblBakeSetSourceEquirect(IblBakeContext* context,
+                                                        const float* rgba,
+                                                        uint32_t width,
+                                                        uint32_t height);
+// RGBA32F, six faces of size * size texels one after another, D3D face order and
+// orientation. Not kept after the call returns.
+IBL_BAKE_API IblBakeResult     iblBakeSetSourceCube(IblBakeContext* context,
+                                                    const float* rgba,
+                                                    uint32_t size);
+
+// Blocks until the bake is done. Running again after changing parameters only redoes
+// the outputs they affect, e.g. IBL_BAKE_DIFFUSE_RESOLUTION leaves the specular alone.
+IBL_BAKE_API IblBakeResult     iblBakeRun(IblBakeContext* context);
+
+// Bakes in the background instead: a copy of the source and parameters is refined
+// in passes, from 64 samples doubling up to IBL_BAKE_SAMPLE_COUNT. Returns at once.
+// A background bake already running is cancelled, as it is by iblBakeRun,
+// iblBakeStop and iblBakeDestroyContext.
+IBL_BAKE_API IblBakeResult     iblBakeStart(IblBakeContext* context);
+// Takes the newest finished pass of iblBakeStart, if there is one, as the outputs
+// of the context. Poll it, e.g. once a frame. sampleCount is set to the samples the
+// outputs have been baked with, 0 if none yet, and running to 0 once the last pass
+// has been taken. Either may be null.
+IBL_BAKE_API IblBakeResult     iblBakeUpdate(IblBakeContext* context,
+                                             uint32_t* sampleCount,
+                                             uint32_t* running);
+IBL_BAKE_API void              iblBakeStop(IblBakeContext* context);
+
+IBL_BAKE_API uint32_t          iblBakeGetMipCount(const IblBakeContext* context,
+                                                  IblBakeOutput output);
+// RGBA32F texels of one face and mip, size * size of them. Owned by the context and
+// valid until the next bake, iblBakeUpdate, source change or destroy. Null if there
+// is no such surface.
+IBL_BAKE_API const float*      iblBakeGetSurface(const IblBakeContext* context,
+                                                 IblBakeOutput output,
+                                                 uint32_t face,
+                                                 uint32_t mip,
+                                                 uint32_t* size);
+// The roughness a specular mip was baked with, also kept in the header of the
+// specular dds files. -1 if there is no such mip.
+IBL_BAKE_API float             iblBakeGetMipRoughness(const IblBakeContext* context,
+                                                      uint32_t mip);
+
+// Writes the dds files the application saves, <base>SpecularHDR.dds and so on, in the
+// formats of the last bake. Changing a format redoes no stage, iblBakeRun is cheap.
+IBL_BAKE_API IblBakeResult     iblBakeWriteFiles(const IblBakeContext* context,
+                                                 const char* basePathName);
+// The files iblBakeWriteFiles writes and a manifest.json (settings, hash, stats,
+// timings) in one zip. IBL_BAKE_WRITE_FAILED in builds without libzip.
+IBL_BAKE_API IblBakeResult     iblBakeWriteBundle(const IblBakeContext* context,
+                                                  const char* filePathName);
+
+// Writes <base>_<name>Specular*.dds and Diffuse*.dds for each target from the last
+// bake, and the <base>Brdf.dds they share. Bake at the largest target resolutions, smaller targets are filtered
+// down from the bake where the mip roughness matches and convolved otherwise.
+IBL_BAKE_API IblBakeResult     iblBakeWriteTargets(const IblBakeContext* context,
+                                                   const char* basePathName,
+                                                   const IblBakeTarget* targets,
+                                                   uint32_t targetCount);
+
+IBL_BAKE_API const char*       iblBakeResultString(IblBakeResult result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,883 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblBakeContext.h>
+#include <IblAsyncLoader.h>
+#include <IblBundle.h>
+#include <IblFileSystem.h>
+#include <IblHalf.h>
+#include <IblParallel.h>
+#include <IblSourceEnvironment.h>
+#include <IblTiledEnvironment.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace Ctr
+{
+namespace
+{
+// HDR as a float cube, the others 8 bit like the MDR outputs of the application.
+bool
+saveCube(const CubeMap& cubeMap, ExportEncoding encoding, const DdsDestination& destination)
+{
+    if (encoding == ExportHdr16 || encoding == ExportHdr32)
+    {
+        return cubeMap.save(destination, encoding == ExportHdr16 ? DdsRgba16f : DdsRgba32f);
+    }
+
+    DdsDescription description(cubeMap.size(), cubeMap.size(), cubeMap.mipCount(), 6, DdsRgba8,
+                               cubeMap.warpedEdges() ? DdsFlagWarpedEdges : 0);
+    description.mipRoughness = cubeMap.mipRoughness();
+    DdsWriter writer;
+    if (!writer.open(destination, description))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> encoded;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t mip = 0; mip < cubeMap.mipCount(); mip++)
+        {
+            size_t texelCount = size_t(cubeMap.mipSize(mip)) * cubeMap.mipSize(mip);
+            encoded.resize(texelCount * 4);
+            if (encoding == ExportRgbd)
+            {
+                encodeRgbd(cubeMap.texels(face, mip), &encoded[0], texelCount);
+            }
+            else
+            {
+                encodeRgbm(cubeMap.texels(face, mip), &encoded[0], texelCount);
+            }
+            writer.write(&encoded[0], encoded.size());
+        }
+    }
+    return writer.close();
+}
+
+const char*
+encodingSuffix(ExportEncoding encoding)
+{
+    switch (encoding)
+    {
+        case ExportRgbm: return "MDR.dds";
+        case ExportRgbd: return "RGBD.dds";
+        default: return "HDR.dds";
+    }
+}
+
+void
+makeParentDirectory(const std::string& pathName)
+{
+    size_t pathEnd = pathName.find_last_of("/\\");
+    if (pathEnd != std::string::npos && pathEnd > 0)
+    {
+        makeDirectory(pathName.substr(0, pathEnd));
+    }
+}
+
+// Drops an extension from basePathName and creates its directory.
+std::string
+outputBase(const std::string& basePathName)
+{
+    std::string base = basePathName;
+    size_t extension = base.rfind('.');
+    if (extension != std::string::npos && base.find_first_of("/\\", extension) == std::string::npos)
+    {
+        base = base.substr(0, extension);
+    }
+    makeParentDirectory(base);
+    return base;
+}
+
+double
+millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// How many halvings take a face of from texels down to to, ~0u if none do.
+uint32_t
+halvings(uint32_t from, uint32_t to)
+{
+    for (uint32_t count = 0; from >= to; count++, from /= 2)
+    {
+        if (from == to)
+        {
+            return count;
+        }
+        if (from == 1)
+        {
+            break;
+        }
+    }
+    return ~0u;
+}
+
+// Face of a baked mip box filtered down halvings times into target.
+void
+filterDown(const CubeMap& baked, uint32_t bakedMip, uint32_t halvingCount, CubeMap& target, uint32_t mip)
+{
+    parallelFor(6, [&](uint32_t begin, uint32_t end)
+    {
+        std::vector<float> scratch[2];
+        for (uint32_t face = begin; face < end; face++)
+        {
+            const float* source = baked.texels(face, bakedMip);
+            uint32_t size = baked.mipSize(bakedMip);
+            for (uint32_t halving = 0; halving < halvingCount; halving++)
+            {
+                bool last = halving + 1 == halvingCount;
+                std::vector<float>& next = scratch[halving % 2];
+                next.resize(size_t(std::max(size / 2, 1u)) * std::max(size / 2, 1u) * 4);
+                float* destination = last ? target.texels(face, mip) : &next[0];
+                downsampleSurface(source, size, destination);
+                source = destination;
+                size = std::max(size / 2, 1u);
+            }
+            if (halvingCount == 0)
+            {
+                memcpy(target.texels(face, mip), source, size_t(size) * size * 4 * sizeof(float));
+            }
+        }
+    });
+}
+
+// The LUT is baked as RGBA32F, the two channel formats drop the last two channels.
+bool
+saveBrdfLut(const float* lut, uint32_t size, DdsFormat format, const DdsDestination& destination)
+{
+    size_t texelCount = size_t(size) * size;
+    uint32_t channelCount = ddsChannelCount(format);
+    std::vector<float> channels(texelCount * channelCount);
+    for (size_t texel = 0; texel < texelCount; texel++)
+    {
+        for (uint32_t channel = 0; channel < channelCount; channel++)
+        {
+            channels[texel * channelCount + channel] = lut[texel * 4 + channel];
+        }
+    }
+
+    DdsDescription description(size, size, 1, 1, format);
+    switch (format)
+    {
+        case DdsRgba32f:
+        case DdsRg32f:
+            return writeDds(destination, description, &channels[0]);
+        case DdsRgba16f:
+        case DdsRg16f:
+        {
+            std::vector<uint16_t> halfs(channels.size());
+            floatToHalf(&channels[0], &halfs[0], channels.size());
+            return writeDds(destination, description, &halfs[0]);
+        }
+        case DdsRg16:
+        {
+            std::vector<uint16_t> unorms(channels.size());
+            for (size_t value = 0; value < channels.size(); value++)
+            {
+                unorms[value] = uint16_t(std::min(std::max(channels[value], 0.0f), 1.0f) * 65535.0f + 0.5f);
+            }
+            return writeDds(destination, description, &unorms[0]);
+        }
+        default:
+            LOG ("The brdf LUT is saved as RG16, RG16F, RG32F, RGBA16F or RGBA32F");
+            return false;
+    }
+}
+
+// A file BakeContext::save writes, name is appended to the base.
+struct OutputFile
+{
+    std::string                name;
+    std::function<bool (const DdsDestination& destination)> write;
+};
+
+// Same names as IBLApplication::saveImages.
+std::vector<OutputFile>
+outputFiles(const BakeContext& context)
+{
+    const CubeMap& environment = context.environment();
+    const CubeMap& specular = context.specular();
+    const CubeMap& diffuse = context.diffuse();
+    // The formats the results were baked with, not any set since. Bake checked that
+    // they fit the results, the multiple scattering channel needs four.
+    const BakeSettings& settings = context.bakedSettings();
+
+    std::vector<OutputFile> files;
+    auto add = [&files](const char* name, std::function<bool (const DdsDestination&)> write)
+    {
+        OutputFile file = { name, write };
+        files.push_back(file);
+    };
+    add("DiffuseMDR.dds", [&](const DdsDestination& destination) { return saveCube(diffuse, ExportRgbm, destination); });
+    add("SpecularMDR.dds", [&](const DdsDestination& destination) { return saveCube(specular, ExportRgbm, destination); });
+    add("EnvMDR.dds", [&](const DdsDestination& destination) { return saveCube(environment, ExportRgbm, destination); });
+    add("Brdf.dds", [&](const DdsDestination& destination)
+    {
+        return saveBrdfLut(context.brdfLut(), context.brdfLutSize(), settings.lutFormat, destination);
+    });
+    add("EnvHDR.dds", [&](const DdsDestination& destination) { return environment.save(destination, settings.format); });
+    add("DiffuseHDR.dds", [&](const DdsDestination& destination) { return diffuse.save(destination, settings.format); });
+    add("SpecularHDR.dds", [&](const DdsDestination& destination) { return specular.save(destination, settings.format); });
+    return files;
+}
+
+// FNV-1a, for the hash in the bundle manifest.
+uint64_t
+hashBytes(const void* data, size_t size, uint64_t hash)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t byte = 0; byte < size; byte++)
+    {
+        hash = (hash ^ bytes[byte]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+const char*
+lutFormatName(DdsFormat format)
+{
+    switch (format)
+    {
+        case DdsRgba16f: return "rgba16f";
+        case DdsRg32f: return "rg32f";
+        case DdsRg16f: return "rg16f";
+        case DdsRg16: return "rg16";
+        default: return "rgba32f";
+    }
+}
+
+// Size, mips and the luminance of mip 0.
+void
+writeCubeStats(std::ostream& stream, const CubeMap& cubeMap)
+{
+    double luminanceSum = 0.0;
+    double maxLuminance = 0.0;
+    size_t texelCount = size_t(cubeMap.size()) * cubeMap.size();
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        const float* texels = cubeMap.texels(face, 0);
+        for (size_t texel = 0; texel < texelCount; texel++)
+        {
+            const float* rgba = texels + texel * 4;
+            double luminance = 0.2126 * rgba[0] + 0.7152 * rgba[1] + 0.0722 * rgba[2];
+            luminanceSum += luminance;
+            maxLuminance = std::max(maxLuminance, luminance);
+        }
+    }
+    stream << "{\"size\": " << cubeMap.size() << ", \"mips\": " << cubeMap.mipCount() <<
+              ", \"averageLuminance\": " << luminanceSum / double(texelCount * 6) <<
+              ", \"maxLuminance\": " << maxLuminance << "}";
+}
+
+
+bool
+sameConvolution(const ConvolutionSettings& a, const ConvolutionSettings& b)
+{
+    // warpEdges is left out, bake sets it from seamFixup.
+    return a.environmentScale == b.environmentScale && a.saturation == b.saturation &&
+           a.hue == b.hue;
+}
+}
+
+const char*
+exportEncodingName(ExportEncoding encoding)
+{
+    switch (encoding)
+    {
+        case ExportHdr16: return "hdr16";
+        case ExportRgbm: return "rgbm";
+        case ExportRgbd: return "rgbd";
+        default: return "hdr32";
+    }
+}
+
+bool
+parseExportEncoding(const std::string& name, ExportEncoding& encoding)
+{
+    const ExportEncoding encodings[] = { ExportHdr16, ExportHdr32, ExportRgbm, ExportRgbd };
+    for (ExportEncoding candidate : encodings)
+    {
+        if (name == exportEncodingName(candidate))
+        {
+            encoding = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+ExportTarget::ExportTarget() :
+    specularResolution(256),
+    diffuseResolution(32),
+    encoding(ExportHdr16)
+{
+}
+
+BakeTimings::BakeTimings() :
+    specularMs(0.0),
+    diffuseMs(0.0),
+    brdfMs(0.0)
+{
+}
+
+BakeSettings::BakeSettings() :
+    sourceResolution(512),
+    specularResolution(256),
+    diffuseResolution(32),
+    sampleCount(1024),
+    mipDrop(0),
+    lutSize(256),
+    lutSampleCount(1024),
+    lutMultiScatter(false),
+    lutFormat(DdsRgba32f),
+    format(DdsRgba32f),
+    memoryBudget(size_t(1024) << 20),
+    seamFixup(SeamFixupAverage)
+{
+}
+
+uint32_t
+bakeStagesChanged(const BakeSettings& from, const BakeSettings& to)
+{
+    uint32_t stages = 0;
+    // Both chains are convolved from the same samples with the same scale and colour
+    // correction, and fixed up the same way.
+    if (from.sampleCount != to.sampleCount || from.seamFixup != to.seamFixup ||
+        !sameConvolution(from.convolution, to.convolution))
+    {
+        stages |= BakeStageSpecular | BakeStageDiffuse;
+    }
+    // The mip drop shortens the chain, which changes the roughness of every mip, as
+    // does another schedule. Only the specular chain has SH mips.
+    if (from.specularResolution != to.specularResolution || from.mipDrop != to.mipDrop ||
+        from.convolution.roughnessSchedule != to.convolution.roughnessSchedule ||
+        from.convolution.shRoughness != to.convolution.shRoughness)
+    {
+        stages |= BakeStageSpecular;
+    }
+    if (from.diffuseResolution != to.diffuseResolution)
+    {
+        stages |= BakeStageDiffuse;
+    }
+    // The diffuse chain samples the cosine lobe, not the BRDF.
+    if (from.convolution.brdf != to.convolution.brdf)
+    {
+        stages |= BakeStageSpecular | BakeStageBrdf;
+    }
+    if (from.lutSize != to.lutSize || from.lutSampleCount != to.lutSampleCount ||
+        from.lutMultiScatter != to.lutMultiScatter)
+    {
+        stages |= BakeStageBrdf;
+    }
+    return stages;
+}
+
+BakeContext::BakeContext() :
+    _hasSource(false),
+    _baked(false),
+    _staleStages(BakeStageAll),
+    _brdfLutSize(0)
+{
+}
+
+BakeSettings&
+BakeContext::settings()
+{
+    return _settings;
+}
+
+const BakeSettings&
+BakeContext::settings() const
+{
+    return _settings;
+}
+
+bool
+BakeContext::setSource(const std::string& filePathName)
+{
+    _baked = false;
+    _staleStages = BakeStageAll;
+    AsyncLoadState state;
+    _hasSource = loadSourceEnvironment(filePathName, _settings.sourceResolution,
+                                       _settings.memoryBudget, _environment, state);
+    return _hasSource;
+}
+
+bool
+BakeContext::setSourceEquirect(const float* rgba, uint32_t width, uint32_t height)
+{
+    _baked = false;
+    _staleStages = BakeStageAll;
+    _hasSource = false;
+    if (!rgba || width == 0 || height == 0 || _settings.sourceResolution == 0)
+    {
+        return false;
+    }
+
+    IBL_TRACE_SCOPE("Load source environment", "load");
+    MemoryRowSource rows(rgba, width, height);
+    AsyncLoadState state;
+    _environment.create(_settings.sourceResolution, cubeMipCount(_settings.sourceResolution));
+    if (!resampleEquirectToCube(rows, _environment, _settings.memoryBudget, state))
+    {
+        return false;
+    }
+
+    _environment.generateMips();
+    _hasSource = true;
+    return true;
+}
+
+bool
+BakeContext::setSourceCube(const float* rgba, uint32_t size)
+{
+    _baked = false;
+    _staleStages = BakeStageAll;
+    _hasSource = false;
+    if (!rgba || size == 0)
+    {
+        return false;
+    }
+
+    size_t faceTexels = size_t(size) * size * 4;
+    _environment.create(size, cubeMipCount(size));
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        memcpy(_environment.texels(face, 0), rgba + face * faceTexels, faceTexels * sizeof(float));
+    }
+
+    _environment.generateMips();
+    _hasSource = true;
+    return true;
+}
+
+bool
+BakeContext::hasSource() const
+{
+    return _hasSource;
+}
+
+bool
+BakeContext::bake()
+{
+    _baked = false;
+    if (!_hasSource)
+    {
+        LOG ("Nothing to bake, no source environment has been set");
+        return false;
+    }
+    if (_settings.specularResolution == 0 || _settings.diffuseResolution == 0 || _settings.lutSize == 0 ||
+        cubeMipCount(_settings.specularResolution) <= _settings.mipDrop)
+    {
+        LOG ("The bake settings leave an output with nothing in it");
+        return false;
+    }
+    if (_settings.sampleCount == 0 || _settings.lutSampleCount == 0)
+    {
+        LOG ("The bake needs at least one sample per texel");
+        return false;
+    }
+    if (_settings.lutMultiScatter && ddsChannelCount(_settings.lutFormat) < 3)
+    {
+        LOG ("The multiple scattering term needs a four channel brdf format");
+        return false;
+    }
+
+    // The environment scale and colour correction are applied while convolving,
+    // the environment outputs are the source as it was loaded.
+    ConvolutionSettings convolution = _settings.convolution;
+    convolution.warpEdges = _settings.seamFixup == SeamFixupWarp;
+    uint32_t stages = staleStages();
+
+    if (stages & BakeStageSpecular)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        _specular.create(_settings.specularResolution, cubeMipCount(_settings.specularResolution) - _settings.mipDrop);
+        {
+            IBL_TRACE_NAMED_SCOPE(specularScope, "Convolve specular", "compute");
+            IBL_TRACE_ARG(specularScope, 0, "samples", _settings.sampleCount);
+            convolveSpecularChain(_environment, _specular, _settings.sampleCount, convolution);
+        }
+        fixCubeSeams(_specular, _settings.seamFixup);
+        _timings.specularMs = millisecondsSince(start);
+    }
+
+    if (stages & BakeStageDiffuse)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        _diffuse.create(_settings.diffuseResolution, 1);
+        {
+            IBL_TRACE_SCOPE("Convolve diffuse", "compute");
+            convolveDiffuse(_environment, _diffuse, _settings.sampleCount, convolution);
+        }
+        fixCubeSeams(_diffuse, _settings.seamFixup);
+        _timings.diffuseMs = millisecondsSince(start);
+    }
+
+    if (stages & BakeStageBrdf)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        _brdfLutSize = _settings.lutSize;
+        _brdfLut.resize(size_t(_brdfLutSize) * _brdfLutSize * 4);
+        IBL_TRACE_SCOPE("Brdf LUT", "compute");
+        computeBrdfLut(_brdfLutSize, _settings.lutSampleCount, _settings.convolution.brdf, _settings.lutMultiScatter,
+                       &_brdfLut[0]);
+        _timings.brdfMs = millisecondsSince(start);
+    }
+
+    _bakedSettings = _settings;
+    _staleStages = 0;
+    _baked = true;
+    return true;
+}
+
+bool
+BakeContext::baked() const
+{
+    return _baked;
+}
+
+uint32_t
+BakeContext::staleStages() const
+{
+    return _staleStages | bakeStagesChanged(_bakedSettings, _settings);
+}
+
+void
+BakeContext::invalidate(uint32_t stages)
+{
+    _staleStages |= stages & BakeStageAll;
+}
+
+const BakeSettings&
+BakeContext::bakedSettings() const
+{
+    return _bakedSettings;
+}
+
+const BakeTimings&
+BakeContext::timings() const
+{
+    return _timings;
+}
+
+void
+BakeContext::copyResults(const BakeContext& other)
+{
+    _baked = other._baked;
+    _bakedSettings = other._bakedSettings;
+    _staleStages = other._staleStages;
+    _timings = other._timings;
+    _specular = other._specular;
+    _diffuse = other._diffuse;
+    _brdfLutSize = other._brdfLutSize;
+    _brdfLut = other._brdfLut;
+}
+
+const CubeMap&
+BakeContext::environment() const
+{
+    return _environment;
+}
+
+const CubeMap&
+BakeContext::specular() const
+{
+    return _specular;
+}
+
+const CubeMap&
+BakeContext::diffuse() const
+{
+    return _diffuse;
+}
+
+const float*
+BakeContext::brdfLut() const
+{
+    return _brdfLut.empty() ? nullptr : &_brdfLut[0];
+}
+
+uint32_t
+BakeContext::brdfLutSize() const
+{
+    return _brdfLutSize;
+}
+
+bool
+BakeContext::save(const std::string& basePathName) const
+{
+    if (!_baked)
+    {
+        LOG ("Nothing to save, the context has not been baked");
+        return false;
+    }
+
+    std::string base = outputBase(basePathName);
+
+    IBL_TRACE_SCOPE("Save", "save");
+    bool saved = true;
+    for (const OutputFile& file : outputFiles(*this))
+    {
+        saved &= file.write(base + file.name);
+    }
+    return saved;
+}
+
+bool
+BakeContext::exportTargets(const std::string& basePathName, const std::vector<ExportTarget>& targets) const
+{
+    if (!_baked)
+    {
+        LOG ("Nothing to export, the context has not been baked");
+        return false;
+    }
+
+    const BakeSettings& settings = _bakedSettings;
+    ConvolutionSettings convolution = settings.convolution;
+    convolution.warpEdges = settings.seamFixup == SeamFixupWarp;
+    std::string base = outputBase(basePathName);
+
+    std::vector<CubeMap> speculars(targets.size());
+    std::vector<CubeMap> diffuses(targets.size());
+    for (size_t targetId = 0; targetId < targets.size(); targetId++)
+    {
+        const ExportTarget& target = targets[targetId];
+        if (target.specularResolution == 0 || target.diffuseResolution == 0 ||
+            cubeMipCount(target.specularResolution) <= settings.mipDrop)
+        {
+            LOG ("Export target " << target.name << " leaves an output with nothing in it");
+            return false;
+        }
+
+        IBL_TRACE_NAMED_SCOPE(targetScope, "Derive target", "compute");
+        IBL_TRACE_ARG(targetScope, 0, "specular", target.specularResolution);
+
+        // Specular mips come from the baked mip of the same roughness, filtered down.
+        // Under 8 texels the box moves the texel directions too far off the lobes,
+        // and convolving costs next to nothing.
+        CubeMap& specular = speculars[targetId];
+        specular.create(target.specularResolution, cubeMipCount(target.specularResolution) - settings.mipDrop);
+        std::vector<bool> convolveMips(specular.mipCount(), true);
+        std::vector<float> mipRoughness(specular.mipCount());
+        for (uint32_t mip = 0; mip < specular.mipCount(); mip++)
+        {
+            mipRoughness[mip] = convolution.roughnessSchedule.roughness(mip, specular.mipCount(), specular.size());
+            for (uint32_t bakedMip = 0; bakedMip < _specular.mipCount() && !convolution.warpEdges; bakedMip++)
+            {
+                uint32_t halvingCount = halvings(_specular.mipSize(bakedMip), specular.mipSize(mip));
+                if (halvingCount != ~0u && (halvingCount == 0 || specular.mipSize(mip) >= 8) &&
+                    _specular.mipRoughness()[bakedMip] == mipRoughness[mip])
+                {
+                    filterDown(_specular, bakedMip, halvingCount, specular, mip);
+                    convolveMips[mip] = false;
+                    break;
+                }
+            }
+        }
+        if (std::find(convolveMips.begin(), convolveMips.end(), true) != convolveMips.end())
+        {
+            convolveSpecularChain(_environment, specular, settings.sampleCount, convolution, convolveMips);
+        }
+        specular.setMipRoughness(mipRoughness);
+        specular.setWarpedEdges(convolution.warpEdges);
+        fixCubeSeams(specular, settings.seamFixup);
+
+        // Irradiance is smooth enough to filter down from any larger baked size.
+        CubeMap& diffuse = diffuses[targetId];
+        diffuse.create(target.diffuseResolution, 1);
+        uint32_t halvingCount = halvings(_diffuse.size(), diffuse.size());
+        if (halvingCount != ~0u && !convolution.warpEdges)
+        {
+            filterDown(_diffuse, 0, halvingCount, diffuse, 0);
+        }
+        else
+        {
+            convolveDiffuse(_environment, diffuse, settings.sampleCount, convolution);
+        }
+        diffuse.setWarpedEdges(convolution.warpEdges);
+        fixCubeSeams(diffuse, settings.seamFixup);
+    }
+
+    // Two files a target and the one LUT they share, encoded and written a file to a
+    // thread.
+    IBL_TRACE_SCOPE("Export", "save");
+    std::vector<uint8_t> saved(targets.size() * 2 + 1, 0);
+    parallelFor(uint32_t(saved.size()), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t file = begin; file < end; file++)
+        {
+            if (file == targets.size() * 2)
+            {
+                saved[file] = saveBrdfLut(&_brdfLut[0], _brdfLutSize, settings.lutFormat, base + "Brdf.dds");
+                continue;
+            }
+
+            const ExportTarget& target = targets[file / 2];
+            std::string name = base + "_" + target.name;
+            if (file % 2 == 0)
+            {
+                saved[file] = saveCube(speculars[file / 2], target.encoding,
+                                       name + "Specular" + encodingSuffix(target.encoding));
+            }
+            else
+            {
+                saved[file] = saveCube(diffuses[file / 2], target.encoding,
+                                       name + "Diffuse" + encodingSuffix(target.encoding));
+            }
+        }
+    });
+    return std::find(saved.begin(), saved.end(), 0) == saved.end();
+}
+
+bool
+BakeContext::saveBundle(const std::string& filePathName) const
+{
+    if (!_baked)
+    {
+        LOG ("Nothing to save, the context has not been baked");
+        return false;
+    }
+    if (!bundlesSupported())
+    {
+        LOG ("Bundles need libzip, this build has none");
+        return false;
+    }
+
+    makeParentDirectory(filePathName);
+    IBL_TRACE_SCOPE("Save bundle", "save");
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    // Encoded into memory a file to a thread, after the manifest.
+    std::vector<OutputFile> files = outputFiles(*this);
+    std::vector<BundleEntry> entries(files.size() + 1);
+    std::vector<uint8_t> encoded(files.size(), 0);
+    parallelFor(uint32_t(files.size()), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t file = begin; file < end; file++)
+        {
+            BundleEntry& entry = entries[file + 1];
+            entry.name = files[file].name;
+            encoded[file] = files[file].write(DdsDestination(entry.bytes));
+        }
+    });
+    if (std::find(encoded.begin(), encoded.end(), 0) != encoded.end())
+    {
+        return false;
+    }
+
+    const BakeSettings& settings = _bakedSettings;
+    const ConvolutionSettings& convolution = settings.convolution;
+    std::ostringstream settingsJson;
+    settingsJson << "{\"sourceResolution\": " << settings.sourceResolution <<
+                    ", \"specularResolution\": " << settings.specularResolution <<
+                    ", \"diffuseResolution\": " << settings.diffuseResolution <<
+                    ", \"sampleCount\": " << settings.sampleCount <<
+                    ", \"mipDrop\": " << settings.mipDrop <<
+                    ", \"lutSize\": " << settings.lutSize <<
+                    ", \"lutSampleCount\": " << settings.lutSampleCount <<
+                    ", \"lutMultiScatter\": " << (settings.lutMultiScatter ? "true" : "false") <<
+                    ", \"lutFormat\": \"" << lutFormatName(settings.lutFormat) << "\"" <<
+                    ", \"hdrFormat\": " << (settings.format == DdsRgba16f ? 16 : 32) <<
+                    ", \"environmentScale\": " << convolution.environmentScale <<
+                    ", \"saturation\": " << convolution.saturation <<
+                    ", \"hue\": " << convolution.hue <<
+                    ", \"shRoughness\": " << convolution.shRoughness <<
+                    ", \"brdf\": \"" << brdfModelName(convolution.brdf) << "\"" <<
+                    ", \"roughnessSchedule\": \"" << roughnessCurveName(convolution.roughnessSchedule.curve) << "\"";
+    // The curve name alone would hash two different tables the same. Nine digits
+    // tell any two floats apart.
+    if (convolution.roughnessSchedule.curve == RoughnessTable)
+    {
+        settingsJson << std::setprecision(9) << ", \"roughnessTable\": [";
+        for (size_t entry = 0; entry < convolution.roughnessSchedule.table.size(); entry++)
+        {
+            settingsJson << (entry ? ", " : "") << convolution.roughnessSchedule.table[entry];
+        }
+        settingsJson << "]" << std::setprecision(6);
+    }
+    settingsJson << ", \"seamFixup\": \"" << seamFixupName(settings.seamFixup) << "\"}";
+
+    // Keyed on what was baked from, the source as loaded and the settings.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        hash = hashBytes(_environment.texels(face, 0),
+                         size_t(_environment.size()) * _environment.size() * 4 * sizeof(float), hash);
+    }
+    hash = hashBytes(settingsJson.str().data(), settingsJson.str().size(), hash);
+
+    std::ostringstream manifest;
+    manifest << "{\n\"version\": 1,\n\"hash\": \"" << std::hex << std::setw(16) << std::setfill('0') << hash <<
+                std::dec << std::setfill(' ') << "\",\n\"settings\": " << settingsJson.str() << ",\n\"mipRoughness\": [";
+    for (size_t mip = 0; mip < _specular.mipRoughness().size(); mip++)
+    {
+        manifest << (mip ? ", " : "") << _specular.mipRoughness()[mip];
+    }
+    manifest << "],\n\"stats\": {\"environment\": ";
+    writeCubeStats(manifest, _environment);
+    manifest << ", \"specular\": ";
+    writeCubeStats(manifest, _specular);
+    manifest << ", \"diffuse\": ";
+    writeCubeStats(manifest, _diffuse);
+    manifest << "},\n\"timings\": {\"specularMs\": " << _timings.specularMs <<
+                ", \"diffuseMs\": " << _timings.diffuseMs << ", \"brdfMs\": " << _timings.brdfMs <<
+                ", \"encodeMs\": " << millisecondsSince(start) << "},\n\"entries\": [\n";
+    for (size_t entryId = 1; entryId < entries.size(); entryId++)
+    {
+        manifest << "{\"name\": \"" << entries[entryId].name << "\", \"bytes\": " << entries[entryId].bytes.size() << "}" <<
+                    (entryId + 1 < entries.size() ? ",\n" : "\n");
+    }
+    manifest << "]\n}\n";
+
+    // First, a reader after the manifest alone stops at the first entry.
+    entries[0].name = "manifest.json";
+    std::string manifestText = manifest.str();
+    entries[0].bytes.assign(manifestText.begin(), manifestText.end());
+    return writeBundle(filePathName, entries);
+}
+}
@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_BAKE_CONTEXT
+#define INCLUDED_IBL_BAKE_CONTEXT
+
+#include <IblPlatform.h>
+#include <IblConvolution.h>
+#include <IblCubeMap.h>
+#include <IblDds.h>
+#include <IblSeamFixup.h>
+
+namespace Ctr
+{
+struct BakeSettings
+{
+    BakeSettings();
+
+    // Cube size that equirect sources are resampled to.
+    uint32_t                   sourceResolution;
+    uint32_t                   specularResolution;
+    uint32_t                   diffuseResolution;
+    uint32_t                   sampleCount;
+    // Specular mips left off the end of the chain.
+    uint32_t                   mipDrop;
+    uint32_t                   lutSize;
+    uint32_t                   lutSampleCount;
+    // Eavg in the third channel of the LUT instead of the roughness, see
+    // computeBrdfLut. Needs a four channel lutFormat.
+    bool                       lutMultiScatter;
+    // Format of the saved LUT. The two channel formats keep scale and bias only.
+    DdsFormat                  lutFormat;
+    // Format of the HDR outputs, RGBA16F or RGBA32F.
+    DdsFormat                  format;
+    // Memory for resampling equirect files.
+    size_t                     memoryBudget;
+    ConvolutionSettings        convolution;
+    // Applied to the specular and diffuse chains as part of the bake, the saved
+    // files are written as they are.
+    SeamFixup                  seamFixup;
+};
+
+// The parts of a bake that can be redone on their own.
+enum BakeStage
+{
+    BakeStageSpecular = 0x1,
+    BakeStageDiffuse = 0x2,
+    BakeStageBrdf = 0x4,
+    BakeStageAll = 0x7
+};
+
+// How an export target's maps are written.
+enum ExportEncoding
+{
+    // <name>SpecularHDR.dds and <name>DiffuseHDR.dds, RGBA16F or RGBA32F.
+    ExportHdr16,
+    ExportHdr32,
+    // <name>SpecularMDR.dds and <name>DiffuseMDR.dds, see encodeRgbm.
+    ExportRgbm,
+    // <name>SpecularRGBD.dds and <name>DiffuseRGBD.dds, see encodeRgbd.
+    ExportRgbd
+};
+
+const char*                    exportEncodingName(ExportEncoding encoding);
+bool                           parseExportEncoding(const std::string& name, ExportEncoding& encoding);
+
+// One of the sets of maps BakeContext::exportTargets writes from a single bake, e.g.
+// one per platform.
+struct ExportTarget
+{
+    ExportTarget();
+
+    // Appended to the base name: <base>_<name>SpecularHDR.dds, ...
+    std::string                name;
+    uint32_t                   specularResolution;
+    uint32_t                   diffuseResolution;
+    ExportEncoding             encoding;
+};
+
+// Wall clock milliseconds of the stages behind the current results. A stage the last
+// bake did not redo keeps the time of the bake that did.
+struct BakeTimings
+{
+    BakeTimings();
+
+    double                     specularMs;
+    double                     diffuseMs;
+    double                     brdfMs;
+};
+
+// The stages whose results differ between two sets of settings. sourceResolution
+// and memoryBudget belong to the source and the formats only to save, so they dirty
+// none. Save still writes the formats of the last bake, bake again to change them.
+uint32_t                       bakeStagesChanged(const BakeSettings& from, const BakeSettings& to);
+
+//------------------------------------------------------------------------------------//
+// The cpu baker: a source environment in, specular, diffuse and brdf maps out. The   //
+// CLI, the bench and the C API in IblBake.h are all built on this. The source can    //
+// come from a file or from texels the caller has already decoded. Sources are        //
+// converted to a cube when they are set, so sourceResolution and memoryBudget have   //
+// to be set before the source. The other settings are read by bake, which redoes     //
+// only the stages a change to the source or settings has made stale since the last   //
+// bake.                                                                              //
+//------------------------------------------------------------------------------------//
+class BakeContext
+{
+  public:
+    BakeContext();
+
+    BakeSettings&              settings();
+    const BakeSettings&        settings() const;
+
+    // hdr or dds, see loadSourceEnvironment.
+    bool                       setSource(const std::string& filePathName);
+    // RGBA32F, width * height texels, top row first.
+    bool                       setSourceEquirect(const float* rgba, uint32_t width, uint32_t height);
+    // RGBA32F faces of size * size texels in D3D order, mip 0 only.
+    bool                       setSourceCube(const float* rgba, uint32_t size);
+    bool                       hasSource() const;
+
+    bool                       bake();
+    bool                       baked() const;
+    // BakeStage bits the next bake will redo.
+    uint32_t                   staleStages() const;
+    // Forces stages to be redone by the next bake.
+    void                       invalidate(uint32_t stages);
+    // The settings the current results were baked with.
+    const BakeSettings&        bakedSettings() const;
+    const BakeTimings&         timings() const;
+    // Takes the results of a context baked from the same source, as if baked here.
+    void                       copyResults(const BakeContext& other);
+
+    // Valid once baked, until the source is set again.
+    const CubeMap&             environment() const;
+    const CubeMap&             specular() const;
+    const CubeMap&             diffuse() const;
+    // lutSize * lutSize RGBA32F texels, see computeBrdfLut.
+    const float*               brdfLut() const;
+    uint32_t                   brdfLutSize() const;
+
+    // Writes the outputs with the names IBLApplication::saveImages gives them, e.g.
+    // <base>SpecularHDR.dds. An extension on basePathName is dropped, and the
+    // directory is created if need be.
+    bool                       save(const std::string& basePathName) const;
+    // Writes the specular and diffuse maps of each target, and <base>Brdf.dds once, the
+    // LUT is the same for every target. A target mip is box
+    // filtered down from the baked mip of the same roughness where there is one, the
+    // rest are convolved from the source already loaded. With SeamFixupWarp every
+    // mip is convolved, warped texels do not filter down. The files are encoded and
+    // written in parallel.
+    bool                       exportTargets(const std::string& basePathName,
+                                             const std::vector<ExportTarget>& targets) const;
+    // One zip in place of the files save writes, under the same names without the
+    // base (SpecularHDR.dds, ...), after a manifest.json of the settings, a hash of
+    // the source and settings, stats of the outputs and the timings. See IblBundle.h,
+    // the bundle is read back and checked before it is kept. Needs libzip, fails
+    // without it.
+    bool                       saveBundle(const std::string& filePathName) const;
+
+  private:
+    BakeSettings               _settings;
+    bool                       _hasSource;
+    bool                       _baked;
+    // Settings the current results were baked with, stages not yet baked from the
+    // current source.
+    BakeSettings               _bakedSettings;
+    uint32_t                   _staleStages;
+    BakeTimings                _timings;
+    CubeMap                    _environment;
+    CubeMap                    _specular;
+    CubeMap                    _diffuse;
+    uint32_t                   _brdfLutSize;
+    std::vector<float>         _brdfLut;
+};
+}
+
+#endif
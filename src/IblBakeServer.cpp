@@ -0,0 +1,468 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#if _WIN32
+// Winsock has to be pulled in before windows.h.
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+#include <IblBakeServer.h>
+#include <CtrLog.h>
+#include <pugixml.hpp>
+#include <algorithm>
+
+namespace Ctr
+{
+namespace
+{
+enum SocketFile
+{
+    SocketFileMissing,
+    SocketFileSocket,
+    SocketFileOther
+};
+
+#if _WIN32
+typedef WSAPOLLFD PollDescriptor;
+const BakeSocket InvalidSocket = INVALID_SOCKET;
+
+void
+closeSocket(BakeSocket socket)
+{
+    closesocket(socket);
+}
+
+int
+pollSockets(std::vector<PollDescriptor>& descriptors, int timeoutMs)
+{
+    return WSAPoll(&descriptors[0], ULONG(descriptors.size()), timeoutMs);
+}
+
+#ifndef IO_REPARSE_TAG_AF_UNIX
+#define IO_REPARSE_TAG_AF_UNIX 0x80000023
+#endif
+
+SocketFile
+socketFile(const std::string& pathName)
+{
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA(pathName.c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE)
+        return SocketFileMissing;
+    FindClose(find);
+
+    // Unix sockets are reparse points with their own tag.
+    if ((findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+        findData.dwReserved0 == IO_REPARSE_TAG_AF_UNIX)
+        return SocketFileSocket;
+    return SocketFileOther;
+}
+#else
+typedef pollfd PollDescriptor;
+const BakeSocket InvalidSocket = -1;
+
+void
+closeSocket(BakeSocket socket)
+{
+    close(socket);
+}
+
+int
+pollSockets(std::vector<PollDescriptor>& descriptors, int timeoutMs)
+{
+    return poll(&descriptors[0], nfds_t(descriptors.size()), timeoutMs);
+}
+
+SocketFile
+socketFile(const std::string& pathName)
+{
+    struct stat status;
+    if (lstat(pathName.c_str(), &status) != 0)
+        return errno == ENOENT ? SocketFileMissing : SocketFileOther;
+    return S_ISSOCK(status.st_mode) ? SocketFileSocket : SocketFileOther;
+}
+#endif
+
+// Only ever removes a socket, a mistyped path must not cost the user a file.
+bool
+removeSocketFile(const std::string& pathName)
+{
+    switch (socketFile(pathName))
+    {
+        case SocketFileMissing:
+            return true;
+        case SocketFileSocket:
+            if (remove(pathName.c_str()) == 0)
+                return true;
+            LOG("Failed to remove bake server socket " << pathName);
+            return false;
+        default:
+            LOG("Bake server socket path " << pathName << " is not a socket, leaving it alone");
+            return false;
+    }
+}
+
+// How often the io thread checks for shutdown.
+const int PollIntervalMs = 100;
+}
+
+BakeClient::BakeClient(BakeSocket socket) :
+    _socket(socket),
+    _connected(true)
+{
+}
+
+BakeClient::~BakeClient()
+{
+    disconnect();
+}
+
+bool
+BakeClient::send(const std::string& message)
+{
+    std::lock_guard<std::mutex> lock(_sendMutex);
+    if (!_connected)
+        return false;
+
+    std::string line = message + "\n";
+    size_t sent = 0;
+    while (sent < line.size())
+    {
+#if _WIN32
+        int result = ::send(_socket, line.c_str() + sent, int(line.size() - sent), 0);
+#else
+        ssize_t result = ::send(_socket, line.c_str() + sent, line.size() - sent, MSG_NOSIGNAL);
+#endif
+        if (result <= 0)
+        {
+            // Client went away. The job keeps running, we just stop talking.
+            _connected = false;
+            return false;
+        }
+        sent += size_t(result);
+    }
+    return true;
+}
+
+void
+BakeClient::disconnect()
+{
+    std::lock_guard<std::mutex> lock(_sendMutex);
+    if (_socket != InvalidSocket)
+    {
+        closeSocket(_socket);
+        _socket = InvalidSocket;
+    }
+    _connected = false;
+}
+
+bool
+BakeClient::connected() const
+{
+    return _connected;
+}
+
+BakeSocket
+BakeClient::socket() const
+{
+    return _socket;
+}
+
+BakeJob::BakeJob() :
+    id(0),
+    priority(0),
+    sequence(0)
+{
+}
+
+bool
+BakeServer::JobOrder::operator()(const BakeJob& a, const BakeJob& b) const
+{
+    // Highest priority first, first come first served within a priority.
+    if (a.priority != b.priority)
+        return a.priority < b.priority;
+    return a.sequence > b.sequence;
+}
+
+BakeServer::BakeServer() :
+    _listenSocket(InvalidSocket),
+    _running(false),
+    _nextJobId(1),
+    _nextSequence(0)
+{
+}
+
+BakeServer::~BakeServer()
+{
+    stop();
+}
+
+bool
+BakeServer::start(const std::string& socketPathName)
+{
+#if _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+    {
+        LOG("Failed to initialize winsock");
+        return false;
+    }
+#endif
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPathName.size() >= sizeof(address.sun_path))
+    {
+        LOG("Bake server socket path is too long " << socketPathName);
+        return false;
+    }
+    strncpy(address.sun_path, socketPathName.c_str(), sizeof(address.sun_path) - 1);
+
+    // A previous daemon that did not shut down cleanly leaves the socket file behind.
+    if (!removeSocketFile(socketPathName))
+        return false;
+
+    _listenSocket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (_listenSocket == InvalidSocket)
+    {
+        LOG("Failed to create bake server socket");
+        return false;
+    }
+
+    if (bind(_listenSocket, (sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(_listenSocket, SOMAXCONN) != 0)
+    {
+        LOG("Failed to bind bake server to " << socketPathName);
+        closeSocket(_listenSocket);
+        _listenSocket = InvalidSocket;
+        return false;
+    }
+
+    _socketPathName = socketPathName;
+    _running = true;
+    _ioThread = std::thread(&BakeServer::serviceSockets, this);
+
+    LOG("Bake server listening on " << socketPathName);
+    return true;
+}
+
+void
+BakeServer::stop()
+{
+    if (!_running)
+        return;
+
+    _running = false;
+    if (_ioThread.joinable())
+        _ioThread.join();
+
+    // Jobs still hold their clients, so close explicitly.
+    for (auto connectionIt = _connections.begin(); connectionIt != _connections.end(); connectionIt++)
+        connectionIt->client->disconnect();
+    _connections.clear();
+
+    closeSocket(_listenSocket);
+    _listenSocket = InvalidSocket;
+    removeSocketFile(_socketPathName);
+
+#if _WIN32
+    WSACleanup();
+#endif
+}
+
+bool
+BakeServer::popJob(BakeJob& job)
+{
+    std::lock_guard<std::mutex> lock(_jobMutex);
+    if (_jobs.empty())
+        return false;
+
+    std::pop_heap(_jobs.begin(), _jobs.end(), JobOrder());
+    job = _jobs.back();
+    _jobs.pop_back();
+    return true;
+}
+
+size_t
+BakeServer::queuedJobCount() const
+{
+    std::lock_guard<std::mutex> lock(_jobMutex);
+    return _jobs.size();
+}
+
+void
+BakeServer::sendProgress(const BakeJob& job, const std::string& stage, uint32_t frame)
+{
+    std::ostringstream message;
+    message << "<Progress Job=\"" << job.id << "\" Stage=\"" << stage << "\" Frame=\"" << frame << "\"/>";
+    job.client->send(message.str());
+}
+
+void
+BakeServer::sendDone(const BakeJob& job, bool succeeded, double seconds)
+{
+    std::ostringstream message;
+    message << "<Done Job=\"" << job.id << "\" Result=\"" << (succeeded ? "Succeeded" : "Failed")
+            << "\" Seconds=\"" << seconds << "\"/>";
+    job.client->send(message.str());
+}
+
+void
+BakeServer::serviceSockets()
+{
+    std::vector<PollDescriptor> descriptors;
+    char buffer[4096];
+
+    while (_running)
+    {
+        // Slot 0 is the listening socket, the rest map onto _connections.
+        descriptors.resize(_connections.size() + 1);
+        descriptors[0].fd = _listenSocket;
+        descriptors[0].events = POLLIN;
+        descriptors[0].revents = 0;
+        for (size_t connectionId = 0; connectionId < _connections.size(); connectionId++)
+        {
+            descriptors[connectionId + 1].fd = _connections[connectionId].client->socket();
+            descriptors[connectionId + 1].events = POLLIN;
+            descriptors[connectionId + 1].revents = 0;
+        }
+
+        if (pollSockets(descriptors, PollIntervalMs) <= 0)
+            continue;
+
+        for (size_t connectionId = _connections.size(); connectionId > 0; connectionId--)
+        {
+            if (!descriptors[connectionId].revents)
+                continue;
+
+            ClientConnection& connection = _connections[connectionId - 1];
+            int received = int(recv(connection.client->socket(), buffer, sizeof(buffer), 0));
+            if (received <= 0)
+            {
+                // The client may only have closed its write side and still be waiting
+                // on progress, so stop reading but leave the socket to the queued jobs.
+                _connections.erase(_connections.begin() + (connectionId - 1));
+                continue;
+            }
+
+            connection.pending.append(buffer, size_t(received));
+            readJobs(connection);
+        }
+
+        if (descriptors[0].revents)
+        {
+            BakeSocket socket = accept(_listenSocket, nullptr, nullptr);
+            if (socket != InvalidSocket)
+            {
+                ClientConnection connection;
+                connection.client.reset(new BakeClient(socket));
+                _connections.push_back(connection);
+            }
+        }
+    }
+}
+
+void
+BakeServer::readJobs(ClientConnection& connection)
+{
+    size_t lineEnd = std::string::npos;
+    while ((lineEnd = connection.pending.find('\n')) != std::string::npos)
+    {
+        std::string line = connection.pending.substr(0, lineEnd);
+        connection.pending.erase(0, lineEnd + 1);
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        BakeJob job;
+        if (!parseJob(line, job))
+        {
+            connection.client->send("<Error Message=\"Malformed bake request\"/>");
+            continue;
+        }
+
+        job.client = connection.client;
+        size_t queuePosition = 0;
+        {
+            std::lock_guard<std::mutex> lock(_jobMutex);
+            job.id = _nextJobId++;
+            job.sequence = _nextSequence++;
+            _jobs.push_back(job);
+            std::push_heap(_jobs.begin(), _jobs.end(), JobOrder());
+
+            // One based rank in the order jobs will be popped.
+            queuePosition = 1 + std::count_if(_jobs.begin(), _jobs.end(),
+                [&job](const BakeJob& queued) { return JobOrder()(job, queued); });
+        }
+
+        std::ostringstream message;
+        message << "<Queued Job=\"" << job.id << "\" Position=\"" << queuePosition << "\"/>";
+        connection.client->send(message.str());
+    }
+}
+
+bool
+BakeServer::parseJob(const std::string& line, BakeJob& job)
+{
+    pugi::xml_document doc;
+    if (!doc.load_buffer(line.c_str(), line.size()))
+        return false;
+
+    pugi::xml_node bakeNode = doc.child("Bake");
+    if (!bakeNode)
+        return false;
+
+    job.inputPathName = bakeNode.attribute("Input").value();
+    job.outputPathName = bakeNode.attribute("Output").value();
+    job.settingsPathName = bakeNode.attribute("Settings").value();
+    job.priority = bakeNode.attribute("Priority").as_int(0);
+
+    return !job.inputPathName.empty() && !job.outputPathName.empty();
+}
+}
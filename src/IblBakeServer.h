@@ -0,0 +1,152 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_BAKE_SERVER
+#define INCLUDED_IBL_BAKE_SERVER
+
+#include <CtrPlatform.h>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace Ctr
+{
+#if _WIN32
+typedef uintptr_t BakeSocket;
+#else
+typedef int BakeSocket;
+#endif
+
+//------------------------------------------------------------------------------------//
+// A connected client. Jobs keep a reference so that progress can be streamed back    //
+// after the job has left the queue.                                                  //
+//------------------------------------------------------------------------------------//
+class BakeClient
+{
+  public:
+    BakeClient(BakeSocket socket);
+    ~BakeClient();
+
+    bool                       send(const std::string& message);
+    void                       disconnect();
+    bool                       connected() const;
+
+    BakeSocket                 socket() const;
+
+  private:
+    BakeSocket                 _socket;
+    std::atomic<bool>          _connected;
+    std::mutex                 _sendMutex;
+};
+
+struct BakeJob
+{
+    BakeJob();
+
+    uint32_t                   id;
+    int32_t                    priority;
+    uint64_t                   sequence;
+    std::string                inputPathName;
+    std::string                outputPathName;
+    std::string                settingsPathName;
+    std::shared_ptr<BakeClient> client;
+};
+
+//------------------------------------------------------------------------------------//
+// Accepts bake jobs over a local (unix domain) socket and hands them to the          //
+// application in priority order. One job per line:                                   //
+//   <Bake Input="env.hdr" Output="out/env.dds" Settings="job.xml" Priority="0"/>     //
+// Replies are also one element per line: Queued, Progress and Done.                  //
+//------------------------------------------------------------------------------------//
+class BakeServer
+{
+  public:
+    BakeServer();
+    ~BakeServer();
+
+    bool                       start(const std::string& socketPathName);
+    void                       stop();
+
+    // Non blocking. Returns false if there is no queued job.
+    bool                       popJob(BakeJob& job);
+    size_t                     queuedJobCount() const;
+
+    void                       sendProgress(const BakeJob& job,
+                                            const std::string& stage,
+                                            uint32_t frame);
+    void                       sendDone(const BakeJob& job,
+                                        bool succeeded,
+                                        double seconds);
+
+  private:
+    struct JobOrder
+    {
+        bool operator()(const BakeJob& a, const BakeJob& b) const;
+    };
+
+    struct ClientConnection
+    {
+        std::shared_ptr<BakeClient> client;
+        std::string            pending;
+    };
+
+    void                       serviceSockets();
+    void                       readJobs(ClientConnection& connection);
+    bool                       parseJob(const std::string& line, BakeJob& job);
+
+    std::string                _socketPathName;
+    BakeSocket                 _listenSocket;
+    std::atomic<bool>          _running;
+    std::thread                _ioThread;
+
+    // Only touched by the io thread while running.
+    std::vector<ClientConnection> _connections;
+
+    mutable std::mutex         _jobMutex;
+    // A heap on JobOrder. Not a priority_queue, a new job counts the ones ahead of it.
+    std::vector<BakeJob>       _jobs;
+    uint32_t                   _nextJobId;
+    uint64_t                   _nextSequence;
+};
+}
+
+#endif
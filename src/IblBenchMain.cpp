@@ -0,0 +1,586 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblAsyncLoader.h>
+#include <IblBenchmark.h>
+#include <IblConvolution.h>
+#include <IblCubeMap.h>
+#include <IblDds.h>
+#include <IblFileSystem.h>
+#include <IblHalf.h>
+#include <IblImageCompare.h>
+#include <IblSourceEnvironment.h>
+#include <algorithm>
+#include <math.h>
+
+using namespace Ctr;
+
+namespace
+{
+const char* BundledEnvironment = "maya/paperMillDiffuseMDR.dds";
+
+// Cube a benchmark leaves behind, checked against a golden bake after the run.
+struct BenchmarkOutput
+{
+    std::string                name;
+    std::shared_ptr<CubeMap>   cubeMap;
+};
+
+// Keeps results alive so the optimizer cannot drop the work being timed.
+volatile float sink = 0;
+
+// Fixed seed so every run benchmarks the same inputs.
+class Random
+{
+  public:
+    Random() : _state(0x2545f491) {}
+
+    float                      next()
+    {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return float(_state & 0xffffff) / float(0x1000000);
+    }
+
+  private:
+    uint32_t                   _state;
+};
+
+// Sky gradient, ground and a small sun a few thousand times brighter than either,
+// so importance sampling sees the kind of range real captures have.
+void
+syntheticSky(const float* direction, float* texel)
+{
+    const float sun[3] = { 0.48f, 0.6f, 0.64f };
+    float height = direction[1];
+    float sunAngle = direction[0] * sun[0] + direction[1] * sun[1] + direction[2] * sun[2];
+
+    texel[0] = height > 0 ? 0.3f + 0.2f * height : 0.15f;
+    texel[1] = height > 0 ? 0.45f + 0.25f * height : 0.12f;
+    texel[2] = height > 0 ? 0.8f + 0.2f * height : 0.1f;
+    texel[3] = 1.0f;
+    if (sunAngle > 0.9995f)
+    {
+        texel[0] += 2000.0f;
+        texel[1] += 1800.0f;
+        texel[2] += 1500.0f;
+    }
+}
+
+void
+createSyntheticEnvironment(CubeMap& environment, uint32_t size)
+{
+    environment.create(size, cubeMipCount(size));
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        float* texel = environment.texels(face, 0);
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++, texel += 4)
+            {
+                float direction[3];
+                cubeDirection(face, (x + 0.5f) / size, (y + 0.5f) / size, direction);
+                syntheticSky(direction, texel);
+            }
+        }
+    }
+    environment.generateMips();
+}
+
+// The same sky as an RGBA32F equirect dds, written a row at a time so writing it
+// does not add to the peak the memory check measures.
+bool
+writeSyntheticEquirect(const std::string& filePathName, uint32_t width, uint32_t height)
+{
+    const float Pi = 3.14159265358979f;
+    DdsWriter writer;
+    if (!writer.open(filePathName, DdsDescription(width, height, 1, 1, DdsRgba32f)))
+    {
+        return false;
+    }
+
+    std::vector<float> row(size_t(width) * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        float theta = Pi * (y + 0.5f) / height;
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float phi = 2.0f * Pi * (1.0f - (x + 0.5f) / width);
+            float direction[3] = { sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi) };
+            syntheticSky(direction, &row[size_t(x) * 4]);
+        }
+        if (!writer.write(&row[0], row.size() * sizeof(float)))
+        {
+            return false;
+        }
+    }
+    return writer.close();
+}
+
+// Streams a synthetic equirect, far bigger than the budget, through
+// loadSourceEnvironment and fails if the peak resident set grew by more than the
+// budget plus MemoryCheckOverhead. Runs on its own, the peak covers the whole run.
+const size_t MemoryCheckOverhead = size_t(8) << 20;
+
+int
+checkSourceMemory(uint32_t budgetMegabytes)
+{
+    const std::string EquirectPathName = "iblbaker_bench_equirect.dds";
+    const uint32_t EquirectWidth = 4096;
+    const uint32_t CubeResolution = 256;
+    if (!writeSyntheticEquirect(EquirectPathName, EquirectWidth, EquirectWidth / 2))
+    {
+        LOG ("Could not write " << EquirectPathName);
+        return 1;
+    }
+
+    size_t budget = size_t(budgetMegabytes) << 20;
+    size_t peakBefore = peakResidentBytes();
+    CubeMap environment;
+    AsyncLoadState loadState;
+    bool loaded = loadSourceEnvironment(EquirectPathName, CubeResolution, budget, environment, loadState);
+    size_t peakAfter = peakResidentBytes();
+    remove(EquirectPathName.c_str());
+    if (!loaded)
+    {
+        LOG ("Could not load " << EquirectPathName);
+        return 1;
+    }
+    if (peakAfter == 0)
+    {
+        LOG ("Peak memory is not available on this platform, skipping the memory check");
+        return 0;
+    }
+
+    size_t growth = peakAfter - std::min(peakAfter, peakBefore);
+    size_t sourceBytes = size_t(EquirectWidth) * (EquirectWidth / 2) * 4 * sizeof(float);
+    LOG ("Streamed a " << (sourceBytes >> 20) << "MB equirect under a " << budgetMegabytes <<
+         "MB budget, peak memory grew by " << (growth >> 20) << "MB");
+    if (growth > budget + MemoryCheckOverhead)
+    {
+        LOG ("MEMORY OVER BUDGET: allowed " << ((budget + MemoryCheckOverhead) >> 20) << "MB");
+        return 1;
+    }
+    return 0;
+}
+
+void
+addMicroBenchmarks(BenchmarkSuite& suite, const CubeMap& environment)
+{
+    const uint32_t Count = 1 << 20;
+    const float normal[3] = { 0.0f, 0.0f, 1.0f };
+
+    suite.add("micro/hammersley_ggx", Count, [=]()
+    {
+        float sum = 0;
+        for (uint32_t index = 0; index < Count; index++)
+        {
+            float xi[2], halfVector[3];
+            hammersley(index, Count, xi);
+            importanceSampleGGX(xi, 0.5f, normal, halfVector);
+            sum += halfVector[2];
+        }
+        sink = sum;
+    });
+
+    std::shared_ptr<std::vector<float>> directions(new std::vector<float>(Count * 3));
+    std::shared_ptr<std::vector<float>> coordinates(new std::vector<float>(Count * 2));
+    Random random;
+    for (uint32_t index = 0; index < Count; index++)
+    {
+        float* direction = &(*directions)[index * 3];
+        cubeDirection(uint32_t(random.next() * 6.0f), random.next(), random.next(), direction);
+        (*coordinates)[index * 2 + 0] = random.next();
+        (*coordinates)[index * 2 + 1] = random.next();
+    }
+
+    suite.add("micro/cube_direction_to_texel", Count, [=]()
+    {
+        float sum = 0;
+        for (uint32_t index = 0; index < Count; index++)
+        {
+            uint32_t face;
+            float u, v;
+            cubeFaceCoordinates(&(*directions)[index * 3], face, u, v);
+            sum += u + v + face;
+        }
+        sink = sum;
+    });
+
+    const CubeMap* source = &environment;
+    suite.add("micro/bilinear_fetch", Count, [=]()
+    {
+        float sum = 0;
+        for (uint32_t index = 0; index < Count; index++)
+        {
+            float rgba[4];
+            source->sampleBilinear(index % 6, 0, (*coordinates)[index * 2], (*coordinates)[index * 2 + 1], rgba);
+            sum += rgba[0];
+        }
+        sink = sum;
+    });
+
+    suite.add("micro/trilinear_fetch", Count, [=]()
+    {
+        float sum = 0;
+        for (uint32_t index = 0; index < Count; index++)
+        {
+            float rgba[4];
+            source->sample(&(*directions)[index * 3], (*coordinates)[index * 2] * 4.0f, rgba);
+            sum += rgba[0];
+        }
+        sink = sum;
+    });
+
+    const size_t TexelCount = size_t(environment.size()) * environment.size();
+    std::shared_ptr<std::vector<uint16_t>> halfs(new std::vector<uint16_t>(TexelCount * 4));
+    std::shared_ptr<std::vector<float>> floats(new std::vector<float>(TexelCount * 4));
+    std::shared_ptr<std::vector<uint8_t>> rgbm(new std::vector<uint8_t>(TexelCount * 4));
+
+    suite.add("micro/float_to_half", double(TexelCount) * 4, [=]()
+    {
+        floatToHalf(source->texels(0, 0), &(*halfs)[0], TexelCount * 4);
+    });
+
+    suite.add("micro/half_to_float", double(TexelCount) * 4, [=]()
+    {
+        halfToFloat(&(*halfs)[0], &(*floats)[0], TexelCount * 4);
+    });
+
+    // Each conversion path on its own, the two above use the best one.
+    const HalfPath halfPaths[] = { HalfPathScalar, HalfPathSse2, HalfPathF16c };
+    for (HalfPath path : halfPaths)
+    {
+        if (!halfPathSupported(path))
+        {
+            continue;
+        }
+
+        suite.add(std::string("micro/float_to_half/") + halfPathName(path), double(TexelCount) * 4, [=]()
+        {
+            floatToHalf(source->texels(0, 0), &(*halfs)[0], TexelCount * 4, path);
+        });
+        suite.add(std::string("micro/half_to_float/") + halfPathName(path), double(TexelCount) * 4, [=]()
+        {
+            halfToFloat(&(*halfs)[0], &(*floats)[0], TexelCount * 4, path);
+        });
+    }
+
+    suite.add("micro/rgbm_encode", double(TexelCount), [=]()
+    {
+        encodeRgbm(source->texels(0, 0), &(*rgbm)[0], TexelCount);
+    });
+
+    std::shared_ptr<CubeMap> candidate(new CubeMap(environment));
+    candidate->texels(0, 0)[0] += 1.0f;
+    suite.add("micro/compare_cube", double(ddsFaceSize(DdsDescription(environment.size(), environment.size(),
+                                                                       environment.mipCount(), 6, DdsRgba32f))) * 6 / 16, [=]()
+    {
+        std::vector<SurfaceComparison> comparisons;
+        compareCubeMaps(*source, *candidate, MipTolerances(), comparisons);
+        sink = float(comparisons[0].error.rmse);
+    });
+
+    // Items are bytes.
+    DdsDescription description(environment.size(), environment.size(), environment.mipCount(), 6, DdsRgba32f);
+    suite.add("micro/dds_write", double(ddsFaceSize(description)) * 6, [=]()
+    {
+        source->save("iblbaker_bench.dds");
+    });
+}
+
+void
+addMacroBenchmarks(BenchmarkSuite& suite,
+                   std::vector<BenchmarkOutput>& outputs,
+                   const std::string& environmentName,
+                   const CubeMap& environment,
+                   const std::vector<uint32_t>& sizes,
+                   const std::vector<uint32_t>& sampleCounts)
+{
+    const CubeMap* source = &environment;
+    for (uint32_t size : sizes)
+    {
+        for (uint32_t sampleCount : sampleCounts)
+        {
+            std::shared_ptr<CubeMap> target(new CubeMap(size, cubeMipCount(size)));
+            double samples = 0;
+            for (uint32_t mip = 0; mip < target->mipCount(); mip++)
+            {
+                samples += 6.0 * target->mipSize(mip) * target->mipSize(mip) * sampleCount;
+            }
+
+            // One pass per mip, and the chain interleaved tile by tile.
+            ConvolutionSettings interleaved;
+            interleaved.interleaveMips = true;
+            std::ostringstream name;
+            name << "specular/" << environmentName << "/" << size << "/" << sampleCount;
+            suite.add(name.str(), samples, [=]()
+            {
+                convolveSpecularChain(*source, *target, sampleCount, ConvolutionSettings());
+            });
+            outputs.push_back({ name.str(), target });
+
+            std::shared_ptr<CubeMap> interleavedTarget(new CubeMap(size, cubeMipCount(size)));
+            std::ostringstream interleavedName;
+            interleavedName << "specular_interleaved/" << environmentName << "/" << size << "/" << sampleCount;
+            suite.add(interleavedName.str(), samples, [=]()
+            {
+                convolveSpecularChain(*source, *interleavedTarget, sampleCount, interleaved);
+            });
+            outputs.push_back({ interleavedName.str(), interleavedTarget });
+        }
+    }
+
+    const uint32_t DiffuseSize = 32;
+    const uint32_t DiffuseSamples = 1024;
+    std::shared_ptr<CubeMap> diffuse(new CubeMap(DiffuseSize, 1));
+    suite.add("diffuse/" + environmentName + "/32/1024", 6.0 * DiffuseSize * DiffuseSize * DiffuseSamples, [=]()
+    {
+        convolveDiffuse(*source, *diffuse, DiffuseSamples, ConvolutionSettings());
+    });
+    outputs.push_back({ "diffuse/" + environmentName + "/32/1024", diffuse });
+}
+
+// Compares each output of a benchmark that ran with its golden bake, or records the
+// golden if there is none yet. Returns how many failed.
+uint32_t
+checkGoldens(const BenchmarkSuite& suite,
+             const std::vector<BenchmarkOutput>& outputs,
+             const std::string& goldenDirectory,
+             const MipTolerances& tolerances)
+{
+    makeDirectory(goldenDirectory);
+
+    uint32_t failures = 0;
+    for (const BenchmarkOutput& output : outputs)
+    {
+        const std::vector<BenchmarkResult>& results = suite.results();
+        if (std::find_if(results.begin(), results.end(),
+                         [&](const BenchmarkResult& result) { return result.name == output.name; }) == results.end())
+        {
+            continue;
+        }
+
+        std::string fileName = output.name;
+        std::replace(fileName.begin(), fileName.end(), '/', '_');
+        std::string goldenPathName = goldenDirectory + "/" + fileName + ".dds";
+
+        CubeMap golden;
+        if (!fileExists(goldenPathName))
+        {
+            output.cubeMap->save(goldenPathName);
+            LOG (output.name << ": recorded golden " << goldenPathName);
+            continue;
+        }
+
+        std::vector<SurfaceComparison> comparisons;
+        if (!golden.load(goldenPathName) ||
+            !compareCubeMaps(golden, *output.cubeMap, tolerances, comparisons) ||
+            !comparisonsPassed(comparisons))
+        {
+            LOG ("GOLDEN MISMATCH " << output.name);
+            for (const SurfaceComparison& comparison : comparisons)
+            {
+                if (!comparison.passed)
+                {
+                    LOG ("    face " << comparison.face << " mip " << comparison.mip <<
+                         ": rmse " << comparison.error.rmse <<
+                         ", luminance " << comparison.error.relativeLuminanceError <<
+                         ", max " << comparison.error.maxError <<
+                         ", log psnr " << comparison.error.logPsnr << " dB");
+                }
+            }
+            failures++;
+        }
+    }
+    return failures;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    std::string outputPathName = "iblbaker_bench.json";
+    std::string baselinePathName;
+    std::string environmentPathName = BundledEnvironment;
+    std::string goldenDirectory;
+    MipTolerances tolerances;
+    double tolerance = 0.1;
+    double minimumSeconds = 1.0;
+    uint32_t sourceMemoryMegabytes = 0;
+
+    for (int32_t argId = 1; argId < argc; argId++)
+    {
+        std::string option = argv[argId];
+        bool hasValue = argId + 1 < argc;
+        if (option == "--filter" && hasValue)
+        {
+            filter = argv[++argId];
+        }
+        else if (option == "--out" && hasValue)
+        {
+            outputPathName = argv[++argId];
+        }
+        else if (option == "--baseline" && hasValue)
+        {
+            baselinePathName = argv[++argId];
+        }
+        else if (option == "--tolerance" && hasValue)
+        {
+            tolerance = atof(argv[++argId]) / 100.0;
+        }
+        else if (option == "--time" && hasValue)
+        {
+            minimumSeconds = atof(argv[++argId]);
+        }
+        else if (option == "--environment" && hasValue)
+        {
+            environmentPathName = argv[++argId];
+        }
+        else if (option == "--golden" && hasValue)
+        {
+            goldenDirectory = argv[++argId];
+        }
+        else if (option == "--golden-tolerances" && hasValue)
+        {
+            if (!readMipTolerances(argv[++argId], tolerances))
+            {
+                return 1;
+            }
+        }
+        else if (option == "--source-memory" && hasValue)
+        {
+            sourceMemoryMegabytes = uint32_t(atoi(argv[++argId]));
+            if (sourceMemoryMegabytes == 0)
+            {
+                LOG ("--source-memory needs a budget in MB");
+                return 1;
+            }
+        }
+        else
+        {
+            LOG ("iblbaker_bench: cpu kernel and convolution benchmarks");
+            LOG ("  --filter <text>       Only run benchmarks whose name contains text.");
+            LOG ("  --out <file>          Write results here, default iblbaker_bench.json.");
+            LOG ("  --baseline <file>     Compare against an earlier --out, exit 1 on regressions.");
+            LOG ("  --tolerance <percent> Slowdown allowed before a regression, default 10.");
+            LOG ("  --time <seconds>      Minimum time per benchmark, default 1.");
+            LOG ("  --environment <file>  Environment to convolve (hdr or dds), default " << BundledEnvironment);
+            LOG ("  --golden <dir>        Check convolution outputs against golden bakes here,");
+            LOG ("                        recording any that are missing. Exit 1 on a mismatch.");
+            LOG ("  --golden-tolerances <xml> Per mip tolerances for --golden.");
+            LOG ("  --source-memory <MB>  Only check that a large equirect streams within this budget,");
+            LOG ("                        exit 1 if peak memory grows by more than it plus " << (MemoryCheckOverhead >> 20) << "MB.");
+            return option == "--help" ? 0 : 1;
+        }
+    }
+
+    // Run from the sandbox, like the baker.
+    setWorkingDirectory("../");
+
+    if (sourceMemoryMegabytes > 0)
+    {
+        return checkSourceMemory(sourceMemoryMegabytes);
+    }
+
+    CubeMap synthetic;
+    createSyntheticEnvironment(synthetic, 512);
+
+    BenchmarkSuite suite;
+    std::vector<BenchmarkOutput> outputs;
+    addMicroBenchmarks(suite, synthetic);
+
+    std::vector<uint32_t> sizes = { 128, 256, 512 };
+    std::vector<uint32_t> sampleCounts = { 64, 256, 1024 };
+    addMacroBenchmarks(suite, outputs, "synthetic", synthetic, sizes, sampleCounts);
+
+    // The file environment only runs the middle of the matrix, the synthetic one
+    // covers the scaling.
+    CubeMap environment;
+    AsyncLoadState loadState;
+    if (loadSourceEnvironment(environmentPathName, 512, size_t(1024) << 20, environment, loadState))
+    {
+        addMacroBenchmarks(suite, outputs, "file", environment, { 256 }, { 256 });
+    }
+    else
+    {
+        LOG ("Could not load " << environmentPathName << ", skipping its benchmarks");
+    }
+
+    const uint32_t LutSize = 256;
+    const uint32_t LutSamples = 1024;
+    std::shared_ptr<std::vector<float>> lut(new std::vector<float>(LutSize * LutSize * 4));
+    suite.add("brdf_lut/256/1024", double(LutSize) * LutSize * LutSamples, [=]()
+    {
+        computeBrdfLut(LutSize, LutSamples, BrdfSmith, false, &(*lut)[0]);
+    });
+    suite.add("brdf_lut_schlick/256/1024", double(LutSize) * LutSize * LutSamples, [=]()
+    {
+        computeBrdfLut(LutSize, LutSamples, BrdfSchlick, false, &(*lut)[0]);
+    });
+
+    suite.run(filter, minimumSeconds);
+    remove("iblbaker_bench.dds");
+
+    if (!suite.write(outputPathName))
+    {
+        return 1;
+    }
+
+    // After the timed runs, so comparisons never land in a measurement.
+    uint32_t goldenFailures = 0;
+    if (!goldenDirectory.empty())
+    {
+        goldenFailures = checkGoldens(suite, outputs, goldenDirectory, tolerances);
+    }
+
+    if (!baselinePathName.empty())
+    {
+        uint32_t regressions = suite.compare(baselinePathName, tolerance);
+        if (regressions > 0)
+        {
+            LOG (regressions << " benchmarks regressed by more than " << tolerance * 100.0 << "%");
+            return 1;
+        }
+    }
+    return goldenFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,292 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblBenchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#if _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace Ctr
+{
+namespace
+{
+double
+seconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Finds "key": in a line written by BenchmarkSuite::write.
+bool
+findValue(const std::string& line, const char* key, std::string& value)
+{
+    std::string quotedKey = std::string("\"") + key + "\":";
+    size_t start = line.find(quotedKey);
+    if (start == std::string::npos)
+    {
+        return false;
+    }
+    start = line.find_first_not_of(' ', start + quotedKey.size());
+    if (start == std::string::npos)
+    {
+        return false;
+    }
+
+    if (line[start] == '"')
+    {
+        size_t end = line.find('"', start + 1);
+        if (end == std::string::npos)
+        {
+            return false;
+        }
+        value = line.substr(start + 1, end - start - 1);
+    }
+    else
+    {
+        size_t end = line.find_first_of(",}", start);
+        value = line.substr(start, end - start);
+    }
+    return true;
+}
+}
+
+BenchmarkResult::BenchmarkResult() :
+    iterations(0),
+    minMilliseconds(0),
+    meanMilliseconds(0),
+    itemsPerSecond(0)
+{
+}
+
+BenchmarkSuite::BenchmarkSuite()
+{
+}
+
+void
+BenchmarkSuite::add(const std::string& name,
+                    double itemsPerIteration,
+                    const std::function<void ()>& body)
+{
+    Benchmark benchmark;
+    benchmark.name = name;
+    benchmark.itemsPerIteration = itemsPerIteration;
+    benchmark.body = body;
+    _benchmarks.push_back(benchmark);
+}
+
+void
+BenchmarkSuite::run(const std::string& filter, double minimumSeconds)
+{
+    for (const Benchmark& benchmark : _benchmarks)
+    {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        // The first run warms caches and thread pools. If it already took longer
+        // than the minimum it is the only one.
+        double start = seconds();
+        benchmark.body();
+        double first = seconds() - start;
+
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        double total = 0;
+        double fastest = first;
+        if (first >= minimumSeconds)
+        {
+            result.iterations = 1;
+            total = first;
+        }
+        else
+        {
+            while (total < minimumSeconds || result.iterations < 3)
+            {
+                start = seconds();
+                benchmark.body();
+                double elapsed = seconds() - start;
+                fastest = result.iterations == 0 ? elapsed : std::min(fastest, elapsed);
+                total += elapsed;
+                result.iterations++;
+            }
+        }
+
+        result.minMilliseconds = fastest * 1000.0;
+        result.meanMilliseconds = total * 1000.0 / result.iterations;
+        result.itemsPerSecond = fastest > 0 ? benchmark.itemsPerIteration / fastest : 0;
+        _results.push_back(result);
+
+        LOG (result.name << ": " << result.minMilliseconds << " ms min, " <<
+             result.meanMilliseconds << " ms mean, " <<
+             result.itemsPerSecond / 1e6 << " M items/s, " << result.iterations << " iterations");
+    }
+}
+
+const std::vector<BenchmarkResult>&
+BenchmarkSuite::results() const
+{
+    return _results;
+}
+
+bool
+BenchmarkSuite::write(const std::string& filePathName) const
+{
+    std::ofstream file(filePathName.c_str());
+    if (!file)
+    {
+        LOG ("Could not write benchmark results to " << filePathName);
+        return false;
+    }
+
+    file.precision(9);
+    file << "{\n\"benchmarks\": [\n";
+    for (size_t index = 0; index < _results.size(); index++)
+    {
+        const BenchmarkResult& result = _results[index];
+        file << "{\"name\": \"" << result.name << "\", " <<
+                "\"iterations\": " << result.iterations << ", " <<
+                "\"minMs\": " << result.minMilliseconds << ", " <<
+                "\"meanMs\": " << result.meanMilliseconds << ", " <<
+                "\"itemsPerSecond\": " << result.itemsPerSecond << "}" <<
+                (index + 1 < _results.size() ? "," : "") << "\n";
+    }
+    file << "]\n}\n";
+    return bool(file);
+}
+
+uint32_t
+BenchmarkSuite::compare(const std::string& baselinePathName, double tolerance) const
+{
+    std::vector<BenchmarkResult> baseline;
+    if (!readBenchmarkResults(baselinePathName, baseline))
+    {
+        LOG ("Could not read benchmark baseline " << baselinePathName);
+        return 0;
+    }
+
+    uint32_t regressions = 0;
+    for (const BenchmarkResult& result : _results)
+    {
+        auto baselineIt = std::find_if(baseline.begin(), baseline.end(),
+                                       [&](const BenchmarkResult& entry) { return entry.name == result.name; });
+        if (baselineIt == baseline.end() || baselineIt->minMilliseconds <= 0)
+        {
+            LOG (result.name << ": not in the baseline");
+            continue;
+        }
+
+        double change = result.minMilliseconds / baselineIt->minMilliseconds - 1.0;
+        if (change > tolerance)
+        {
+            LOG ("REGRESSION " << result.name << ": " << baselineIt->minMilliseconds << " ms -> " <<
+                 result.minMilliseconds << " ms (+" << change * 100.0 << "%)");
+            regressions++;
+        }
+        else
+        {
+            LOG (result.name << ": " << change * 100.0 << "%");
+        }
+    }
+    return regressions;
+}
+
+bool
+readBenchmarkResults(const std::string& filePathName, std::vector<BenchmarkResult>& results)
+{
+    std::ifstream file(filePathName.c_str());
+    if (!file)
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        BenchmarkResult result;
+        std::string iterations, minMilliseconds, meanMilliseconds, itemsPerSecond;
+        if (findValue(line, "name", result.name) &&
+            findValue(line, "iterations", iterations) &&
+            findValue(line, "minMs", minMilliseconds) &&
+            findValue(line, "meanMs", meanMilliseconds) &&
+            findValue(line, "itemsPerSecond", itemsPerSecond))
+        {
+            result.iterations = uint32_t(atoi(iterations.c_str()));
+            result.minMilliseconds = atof(minMilliseconds.c_str());
+            result.meanMilliseconds = atof(meanMilliseconds.c_str());
+            result.itemsPerSecond = atof(itemsPerSecond.c_str());
+            results.push_back(result);
+        }
+    }
+    return true;
+}
+
+size_t
+peakResidentBytes()
+{
+#if _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    #if __APPLE__
+        return size_t(usage.ru_maxrss);
+    #else
+        // Linux counts in kilobytes.
+        return size_t(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+}
+}
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_BENCHMARK
+#define INCLUDED_IBL_BENCHMARK
+
+#include <IblPlatform.h>
+#include <functional>
+
+namespace Ctr
+{
+struct BenchmarkResult
+{
+    BenchmarkResult();
+
+    std::string                name;
+    uint32_t                   iterations;
+    double                     minMilliseconds;
+    double                     meanMilliseconds;
+    // Items are whatever the benchmark counts: samples, texels, bytes.
+    double                     itemsPerSecond;
+};
+
+//------------------------------------------------------------------------------------//
+// Runs timed benchmarks for iblbaker_bench. Each benchmark repeats until it has run  //
+// for the minimum time; the fastest iteration is what gets compared, since it is     //
+// the least disturbed by whatever else the machine is doing.                          //
+// Results are written as json, one benchmark per line, and can be compared against  //
+// a previous run to catch regressions.                                               //
+//------------------------------------------------------------------------------------//
+class BenchmarkSuite
+{
+  public:
+    BenchmarkSuite();
+
+    void                       add(const std::string& name,
+                                   double itemsPerIteration,
+                                   const std::function<void ()>& body);
+
+    // Runs the benchmarks whose names contain filter, all of them if it is empty.
+    void                       run(const std::string& filter, double minimumSeconds);
+
+    const std::vector<BenchmarkResult>& results() const;
+
+    bool                       write(const std::string& filePathName) const;
+
+    // Logs every benchmark whose fastest time is more than tolerance (0.1 is 10%)
+    // slower than in the baseline and returns how many there were.
+    uint32_t                   compare(const std::string& baselinePathName, double tolerance) const;
+
+  private:
+    struct Benchmark
+    {
+        std::string            name;
+        double                 itemsPerIteration;
+        std::function<void ()> body;
+    };
+
+    std::vector<Benchmark>     _benchmarks;
+    std::vector<BenchmarkResult> _results;
+};
+
+// Reads a file written by BenchmarkSuite::write.
+bool                           readBenchmarkResults(const std::string& filePathName,
+                                                    std::vector<BenchmarkResult>& results);
+
+// Largest resident set the process has had so far in bytes, 0 where it is not known.
+size_t                         peakResidentBytes();
+}
+
+#endif
@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_BRDF
+#define INCLUDED_IBL_BRDF
+
+#include <IblPlatform.h>
+#include <math.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Cpu versions of the .brdf files, one policy per file. A policy is put together     //
+// from its geometry, fresnel and distribution terms, and the LUT and specular        //
+// kernels in IblConvolution.cpp are instantiated per policy, so the terms inline     //
+// into the sample loops. A new BRDF is a policy here, a BrdfModel and a case in the  //
+// dispatch of IblConvolution.cpp. The terms are written as the .brdf files write     //
+// them, so a change to a file has to be made here as well.                           //
+//------------------------------------------------------------------------------------//
+enum BrdfModel
+{
+    // smith.brdf, the default.
+    BrdfSmith,
+    // schlick.brdf.
+    BrdfSchlick
+};
+
+const char*                    brdfModelName(BrdfModel model);
+bool                           parseBrdfModel(const std::string& name, BrdfModel& model);
+
+// G(v) for GGX, as the .brdf files call it with the squared roughness.
+struct SmithGgxGeometry
+{
+    static float               geometry(float NoV, float roughness)
+    {
+        float r2 = roughness * roughness;
+        return NoV * 2.0f / (NoV + sqrtf(NoV * NoV * (1.0f - r2) + r2));
+    }
+};
+
+// Schlick-Beckmann G(v).
+struct SchlickBeckmannGeometry
+{
+    static float               geometry(float NoV, float roughness)
+    {
+        float k = roughness * 0.5f;
+        return NoV / (NoV * (1.0f - k) + k);
+    }
+};
+
+struct SchlickFresnel
+{
+    static float               fresnel(float VoH)
+    {
+        float f = 1.0f - VoH;
+        float f2 = f * f;
+        return f2 * f2 * f;
+    }
+};
+
+// D(h) for GGX, without the 1 / pi the probe shader does not need.
+struct GgxDistribution
+{
+    static float               distribution(float roughness, float NoH)
+    {
+        float r2 = roughness * roughness;
+        float NoH2 = NoH * NoH;
+        float denominator = NoH2 * (r2 - 1.0f) + 1.0f;
+        return r2 / (denominator * denominator);
+    }
+};
+
+// D(h) as schlick.brdf has it. The exponent is (NoH2 - 1) / r2 * NoH2 there, not
+// the (NoH2 - 1) / (r2 * NoH2) of Beckmann, and is kept that way to match the gpu.
+struct BeckmannDistribution
+{
+    static float               distribution(float roughness, float NoH)
+    {
+        float r2 = roughness * roughness;
+        float NoH2 = NoH * NoH;
+        return expf((NoH2 - 1.0f) / r2 * NoH2) / (3.14159f * r2 * NoH2 * NoH2);
+    }
+};
+
+template <class Geometry, class Fresnel, class Distribution>
+struct Brdf
+{
+    // geometryForLut and visibilityForLut.
+    static float               geometry(float roughness, float NoL)
+    {
+        return Geometry::geometry(NoL, roughness * roughness);
+    }
+
+    static float               visibility(float roughness, float NoV)
+    {
+        return Geometry::geometry(NoV, roughness * roughness);
+    }
+
+    // fresnelForLut.
+    static float               fresnel(float VoH)
+    {
+        return Fresnel::fresnel(VoH);
+    }
+
+    // specularD.
+    static float               distribution(float roughness, float NoH)
+    {
+        return Distribution::distribution(roughness, NoH);
+    }
+};
+
+typedef Brdf<SmithGgxGeometry, SchlickFresnel, GgxDistribution> SmithBrdf;
+typedef Brdf<SchlickBeckmannGeometry, SchlickFresnel, BeckmannDistribution> SchlickBrdf;
+}
+
+#endif
@@ -0,0 +1,308 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblBundle.h>
+#include <IblParallel.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <stdio.h>
+
+// Critter's libzip, or the system's.
+#if !IBL_CPU_ONLY || IBL_HAS_LIBZIP
+#define IBL_BUNDLES 1
+#include <zip.h>
+#else
+#define IBL_BUNDLES 0
+#endif
+
+namespace Ctr
+{
+#if IBL_BUNDLES
+namespace
+{
+// Bytes read at a time when checking an entry.
+const size_t VerifyChunkBytes = 1 << 20;
+
+// An entry deflated into an archive of its own, in memory.
+struct DeflatedEntry
+{
+    DeflatedEntry();
+
+    zip_t*                     archive;
+    uint64_t                   compressedSize;
+    bool                       stored;
+};
+
+DeflatedEntry::DeflatedEntry() :
+    archive(nullptr),
+    compressedSize(0),
+    stored(false)
+{
+}
+
+bool
+deflateEntry(const BundleEntry& entry, DeflatedEntry& deflated)
+{
+    zip_error_t error;
+    zip_error_init(&error);
+    zip_source_t* buffer = zip_source_buffer_create(nullptr, 0, 0, &error);
+    zip_t* archive = buffer ? zip_open_from_source(buffer, ZIP_TRUNCATE, &error) : nullptr;
+    if (!archive)
+    {
+        LOG ("Failed to deflate " << entry.name << ": " << zip_error_strerror(&error));
+        zip_source_free(buffer);
+        zip_error_fini(&error);
+        return false;
+    }
+    zip_error_fini(&error);
+
+    // The archive owns buffer from here. The extra reference keeps what zip_close
+    // writes into it.
+    zip_source_keep(buffer);
+    zip_source_t* source = zip_source_buffer(archive, &entry.bytes[0], entry.bytes.size(), 0);
+    bool added = source && zip_file_add(archive, entry.name.c_str(), source, ZIP_FL_OVERWRITE) >= 0;
+    if (source && !added)
+    {
+        zip_source_free(source);
+    }
+    if (!added || zip_close(archive) != 0)
+    {
+        LOG ("Failed to deflate " << entry.name << ": " << zip_strerror(archive));
+        zip_discard(archive);
+        zip_source_free(buffer);
+        return false;
+    }
+
+    zip_error_init(&error);
+    deflated.archive = zip_open_from_source(buffer, ZIP_RDONLY, &error);
+    zip_stat_t stat;
+    zip_stat_init(&stat);
+    if (!deflated.archive || zip_stat_index(deflated.archive, 0, 0, &stat) != 0)
+    {
+        LOG ("Failed to reopen " << entry.name << " deflated: " << zip_error_strerror(&error));
+        if (!deflated.archive)
+        {
+            zip_source_free(buffer);
+        }
+        zip_error_fini(&error);
+        return false;
+    }
+    zip_error_fini(&error);
+
+    deflated.compressedSize = stat.comp_size;
+    deflated.stored = stat.comp_size * 20 > stat.size * 19;
+    return true;
+}
+
+zip_source_t*
+compressedSource(zip_t* bundle, zip_t* deflated)
+{
+#if defined(LIBZIP_VERSION_MAJOR) && (LIBZIP_VERSION_MAJOR > 1 || LIBZIP_VERSION_MINOR >= 10)
+    return zip_source_zip_file(bundle, deflated, 0, ZIP_FL_COMPRESSED, 0, -1, nullptr, nullptr);
+#else
+    return zip_source_zip(bundle, deflated, 0, ZIP_FL_COMPRESSED, 0, -1);
+#endif
+}
+
+// The deflated archives have to stay open until the bundle is closed.
+bool
+assembleBundle(const std::string& filePathName,
+               const std::vector<BundleEntry>& entries,
+               const std::vector<DeflatedEntry>& deflated)
+{
+    int errorCode = 0;
+    zip_t* bundle = zip_open(filePathName.c_str(), ZIP_CREATE | ZIP_TRUNCATE, &errorCode);
+    if (!bundle)
+    {
+        zip_error_t error;
+        zip_error_init_with_code(&error, errorCode);
+        LOG ("Failed to create " << filePathName << ": " << zip_error_strerror(&error));
+        zip_error_fini(&error);
+        return false;
+    }
+
+    bool added = true;
+    for (size_t entryId = 0; added && entryId < entries.size(); entryId++)
+    {
+        const BundleEntry& entry = entries[entryId];
+        bool copied = deflated[entryId].archive && !deflated[entryId].stored;
+        zip_source_t* source = copied ? compressedSource(bundle, deflated[entryId].archive) :
+                                        zip_source_buffer(bundle, entry.bytes.data(), entry.bytes.size(), 0);
+        zip_int64_t index = source ? zip_file_add(bundle, entry.name.c_str(), source, ZIP_FL_OVERWRITE) : -1;
+        if (source && index < 0)
+        {
+            zip_source_free(source);
+        }
+        added = index >= 0 &&
+                (!deflated[entryId].stored ||
+                 zip_set_file_compression(bundle, zip_uint64_t(index), ZIP_CM_STORE, 0) == 0);
+    }
+
+    if (!added || zip_close(bundle) != 0)
+    {
+        LOG ("Failed to write " << filePathName << ": " << zip_strerror(bundle));
+        zip_discard(bundle);
+        return false;
+    }
+    return true;
+}
+}
+
+bool
+bundlesSupported()
+{
+    return true;
+}
+
+bool
+writeBundle(const std::string& filePathName, const std::vector<BundleEntry>& entries)
+{
+    IBL_TRACE_SCOPE("Write bundle", "save");
+    std::vector<DeflatedEntry> deflated(entries.size());
+    std::vector<uint8_t> failed(entries.size(), 0);
+    parallelFor(uint32_t(entries.size()), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t entryId = begin; entryId < end; entryId++)
+        {
+            if (entries[entryId].bytes.size() >= BundleParallelBytes)
+            {
+                IBL_TRACE_SCOPE("Deflate", "save");
+                failed[entryId] = !deflateEntry(entries[entryId], deflated[entryId]);
+            }
+        }
+    });
+
+    bool written = std::find(failed.begin(), failed.end(), 1) == failed.end() &&
+                   assembleBundle(filePathName, entries, deflated);
+    for (const DeflatedEntry& entry : deflated)
+    {
+        if (entry.archive)
+        {
+            zip_discard(entry.archive);
+        }
+    }
+
+    if (written && !verifyBundle(filePathName, entries))
+    {
+        remove(filePathName.c_str());
+        written = false;
+    }
+    return written;
+}
+
+bool
+verifyBundle(const std::string& filePathName, const std::vector<BundleEntry>& entries)
+{
+    IBL_TRACE_SCOPE("Verify bundle", "save");
+    int errorCode = 0;
+    zip_t* bundle = zip_open(filePathName.c_str(), ZIP_RDONLY | ZIP_CHECKCONS, &errorCode);
+    if (!bundle)
+    {
+        LOG ("Failed to open " << filePathName << " to verify it, libzip error " << errorCode);
+        return false;
+    }
+
+    bool verified = zip_get_num_entries(bundle, 0) == zip_int64_t(entries.size());
+    if (!verified)
+    {
+        LOG (filePathName << " holds " << zip_get_num_entries(bundle, 0) << " entries, not " << entries.size());
+    }
+
+    // zip_fread fails on a crc mismatch once an entry has been read to the end.
+    std::vector<uint8_t> chunk(VerifyChunkBytes);
+    for (auto entryIt = entries.begin(); verified && entryIt != entries.end(); entryIt++)
+    {
+        zip_int64_t index = zip_name_locate(bundle, entryIt->name.c_str(), 0);
+        zip_file_t* file = index >= 0 ? zip_fopen_index(bundle, zip_uint64_t(index), 0) : nullptr;
+        size_t offset = 0;
+        while (file)
+        {
+            zip_int64_t readSize = zip_fread(file, &chunk[0], chunk.size());
+            if (readSize <= 0)
+            {
+                verified = readSize == 0 && offset == entryIt->bytes.size();
+                break;
+            }
+            if (offset + size_t(readSize) > entryIt->bytes.size() ||
+                memcmp(&chunk[0], &entryIt->bytes[offset], size_t(readSize)) != 0)
+            {
+                verified = false;
+                break;
+            }
+            offset += size_t(readSize);
+        }
+        verified = file && verified;
+        if (file)
+        {
+            verified = zip_fclose(file) == 0 && verified;
+        }
+        if (!verified)
+        {
+            LOG (entryIt->name << " in " << filePathName << " does not match what was written");
+        }
+    }
+
+    zip_discard(bundle);
+    return verified;
+}
+#else
+bool
+bundlesSupported()
+{
+    return false;
+}
+
+bool
+writeBundle(const std::string& filePathName, const std::vector<BundleEntry>& entries)
+{
+    LOG ("Bundles need libzip, this build has none");
+    return false;
+}
+
+bool
+verifyBundle(const std::string& filePathName, const std::vector<BundleEntry>& entries)
+{
+    LOG ("Bundles need libzip, this build has none");
+    return false;
+}
+#endif
+}
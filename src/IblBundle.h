@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_BUNDLE
+#define INCLUDED_IBL_BUNDLE
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Bundles pack the outputs of a bake into one zip, see BakeContext::saveBundle. The  //
+// entries are in memory. Those of BundleParallelBytes or more are deflated each on   //
+// its own thread into an archive in memory, and the compressed stream is copied      //
+// into the bundle as it is. Entries deflate shrinks by under 5% are stored. Written  //
+// with Critter's libzip, or the system's in IBL_CPU_ONLY builds when CMake finds it. //
+//------------------------------------------------------------------------------------//
+struct BundleEntry
+{
+    std::string                name;
+    std::vector<uint8_t>       bytes;
+};
+
+const size_t                   BundleParallelBytes = 64 << 10;
+
+// False in builds without libzip, where writeBundle and verifyBundle fail.
+bool                           bundlesSupported();
+
+// Writes the entries in order, then reads the bundle back with verifyBundle. A bundle
+// that does not verify is removed.
+bool                           writeBundle(const std::string& filePathName,
+                                           const std::vector<BundleEntry>& entries);
+
+// The bundle holds exactly these entries, each inflates to its bytes and passes its
+// crc.
+bool                           verifyBundle(const std::string& filePathName,
+                                            const std::vector<BundleEntry>& entries);
+}
+
+#endif
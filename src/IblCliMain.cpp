@@ -0,0 +1,424 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblBake.h>
+#include <IblBakeContext.h>
+#include <IblBrdf.h>
+#include <IblPlatform.h>
+#include <IblRoughnessSchedule.h>
+#include <IblSeamFixup.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+
+// iblBakerConfig.xml is read with Critter's pugixml, when it is checked out.
+#if !IBL_CPU_ONLY || IBL_HAS_PUGIXML
+#define IBL_CONFIG_FILES 1
+#include <pugixml.hpp>
+#else
+#define IBL_CONFIG_FILES 0
+#endif
+
+namespace
+{
+struct CliOptions
+{
+    CliOptions() :
+        bundle(false)
+    {
+    }
+
+    std::string                environmentPathName;
+    std::string                outputPathName;
+    // One specular chain is baked for each, from the same source.
+    std::vector<Ctr::RoughnessCurve> roughnessCurves;
+    std::vector<float>         roughnessTable;
+    // Written from the one bake instead of the standard files.
+    std::vector<Ctr::ExportTarget> targets;
+    // <out>.zip instead of the standard files.
+    bool                       bundle;
+};
+
+// Plain decimal only, atoi would turn "abc" or "-1" into a count.
+bool
+parseUnsigned(const char* value, uint32_t& number)
+{
+    if (!isdigit((unsigned char)value[0]))
+    {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    unsigned long parsed = strtoul(value, &end, 10);
+    if (*end != 0 || errno == ERANGE || parsed > 0xffffffffUL)
+    {
+        return false;
+    }
+    number = uint32_t(parsed);
+    return true;
+}
+
+// name:specular:diffuse:encoding, e.g. mobile:128:16:rgbm.
+bool
+parseTarget(const std::string& value, Ctr::ExportTarget& target)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (start <= value.size())
+    {
+        size_t end = std::min(value.find(':', start), value.size());
+        fields.push_back(value.substr(start, end - start));
+        start = end + 1;
+    }
+    if (fields.size() != 4 || fields[0].empty())
+    {
+        return false;
+    }
+
+    target.name = fields[0];
+    return parseUnsigned(fields[1].c_str(), target.specularResolution) &&
+           parseUnsigned(fields[2].c_str(), target.diffuseResolution) &&
+           target.specularResolution > 0 && target.diffuseResolution > 0 &&
+           Ctr::parseExportEncoding(fields[3], target.encoding);
+}
+
+bool
+parseRoughnessCurves(const std::string& names, std::vector<Ctr::RoughnessCurve>& curves)
+{
+    curves.clear();
+    size_t start = 0;
+    while (start <= names.size())
+    {
+        size_t end = std::min(names.find(',', start), names.size());
+        Ctr::RoughnessCurve curve;
+        if (!Ctr::parseRoughnessCurve(names.substr(start, end - start), curve))
+        {
+            return false;
+        }
+        curves.push_back(curve);
+        start = end + 1;
+    }
+    return true;
+}
+
+// RoughnessSchedule and RoughnessTable of the Config node, as in
+// data/iblBakerConfig.xml.
+bool
+readConfig(const std::string& filePathName, CliOptions& options)
+{
+#if !IBL_CONFIG_FILES
+    LOG ("Built without pugixml, cannot read " << filePathName);
+    return false;
+#else
+    pugi::xml_document document;
+    if (!document.load_file(filePathName.c_str()))
+    {
+        LOG ("Could not read " << filePathName);
+        return false;
+    }
+
+    pugi::xml_node configNode = document.child("Config");
+    if (pugi::xml_attribute attribute = configNode.attribute("RoughnessTable"))
+    {
+        if (!Ctr::parseRoughnessTable(attribute.value(), options.roughnessTable))
+        {
+            return false;
+        }
+    }
+    if (pugi::xml_attribute attribute = configNode.attribute("RoughnessSchedule"))
+    {
+        if (!parseRoughnessCurves(attribute.value(), options.roughnessCurves))
+        {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+IblBakeResult
+setRoughnessSchedule(IblBakeContext* context, Ctr::RoughnessCurve curve, const std::vector<float>& table)
+{
+    if (curve == Ctr::RoughnessTable)
+    {
+        return iblBakeSetRoughnessTable(context, &table[0], uint32_t(table.size()));
+    }
+    return iblBakeSetParameter(context, IBL_BAKE_ROUGHNESS_CURVE, uint32_t(curve));
+}
+
+bool
+setParameter(IblBakeContext* context, IblBakeParameter parameter, const char* value)
+{
+    uint32_t number = 0;
+    return parseUnsigned(value, number) && iblBakeSetParameter(context, parameter, number) == IBL_BAKE_OK;
+}
+
+bool
+setFloatParameter(IblBakeContext* context, IblBakeFloatParameter parameter, const char* value)
+{
+    // iblBakeSetFloatParameter turns down NaN and out of range values, not text.
+    char* end = nullptr;
+    float number = float(strtod(value, &end));
+    return end != value && *end == 0 && iblBakeSetFloatParameter(context, parameter, number) == IBL_BAKE_OK;
+}
+
+bool
+parseOptions(int argc, char* argv[], CliOptions& options, IblBakeContext* context)
+{
+    for (int32_t argId = 1; argId < argc; argId++)
+    {
+        std::string option = argv[argId];
+        bool hasValue = argId + 1 < argc;
+        bool valid = true;
+        if (option == "--environment" && hasValue)
+            options.environmentPathName = argv[++argId];
+        else if (option == "--out" && hasValue)
+            options.outputPathName = argv[++argId];
+        else if (option == "--source-resolution" && hasValue)
+            valid = setParameter(context, IBL_BAKE_SOURCE_RESOLUTION, argv[++argId]);
+        else if (option == "--specular-resolution" && hasValue)
+            valid = setParameter(context, IBL_BAKE_SPECULAR_RESOLUTION, argv[++argId]);
+        else if (option == "--diffuse-resolution" && hasValue)
+            valid = setParameter(context, IBL_BAKE_DIFFUSE_RESOLUTION, argv[++argId]);
+        else if (option == "--samples" && hasValue)
+            valid = setParameter(context, IBL_BAKE_SAMPLE_COUNT, argv[++argId]);
+        else if (option == "--mip-drop" && hasValue)
+            valid = setParameter(context, IBL_BAKE_MIP_DROP, argv[++argId]);
+        else if (option == "--format" && hasValue)
+            valid = setParameter(context, IBL_BAKE_HDR_FORMAT, argv[++argId]);
+        else if (option == "--source-memory" && hasValue)
+            valid = setParameter(context, IBL_BAKE_SOURCE_MEMORY, argv[++argId]);
+        else if (option == "--scale" && hasValue)
+            valid = setFloatParameter(context, IBL_BAKE_ENVIRONMENT_SCALE, argv[++argId]);
+        else if (option == "--saturation" && hasValue)
+            valid = setFloatParameter(context, IBL_BAKE_SATURATION, argv[++argId]);
+        else if (option == "--hue" && hasValue)
+            valid = setFloatParameter(context, IBL_BAKE_HUE, argv[++argId]);
+        else if (option == "--sh-roughness" && hasValue)
+            valid = setFloatParameter(context, IBL_BAKE_SH_ROUGHNESS, argv[++argId]);
+        else if (option == "--seams" && hasValue)
+        {
+            Ctr::SeamFixup fixup;
+            valid = Ctr::parseSeamFixup(argv[++argId], fixup) &&
+                    iblBakeSetParameter(context, IBL_BAKE_SEAM_FIXUP, uint32_t(fixup)) == IBL_BAKE_OK;
+        }
+        else if (option == "--brdf" && hasValue)
+        {
+            Ctr::BrdfModel brdf;
+            valid = Ctr::parseBrdfModel(argv[++argId], brdf) &&
+                    iblBakeSetParameter(context, IBL_BAKE_BRDF_MODEL, uint32_t(brdf)) == IBL_BAKE_OK;
+        }
+        else if (option == "--brdf-format" && hasValue)
+        {
+            const char* formats[] = { "rgba32f", "rgba16f", "rg32f", "rg16f", "rg16" };
+            std::string format = argv[++argId];
+            uint32_t formatId = 0;
+            while (formatId < 5 && format != formats[formatId])
+                formatId++;
+            valid = iblBakeSetParameter(context, IBL_BAKE_BRDF_FORMAT, formatId) == IBL_BAKE_OK;
+        }
+        else if (option == "--brdf-multiscatter" && hasValue)
+            valid = setParameter(context, IBL_BAKE_BRDF_MULTISCATTER, argv[++argId]);
+        else if (option == "--roughness" && hasValue)
+            valid = parseRoughnessCurves(argv[++argId], options.roughnessCurves);
+        else if (option == "--roughness-table" && hasValue)
+            valid = Ctr::parseRoughnessTable(argv[++argId], options.roughnessTable);
+        else if (option == "--target" && hasValue)
+        {
+            Ctr::ExportTarget target;
+            valid = parseTarget(argv[++argId], target);
+            options.targets.push_back(target);
+        }
+        else if (option == "--bundle" && hasValue)
+        {
+            uint32_t bundle = 0;
+            valid = parseUnsigned(argv[++argId], bundle) && bundle <= 1;
+            options.bundle = bundle != 0;
+        }
+        else if (option == "--config" && hasValue)
+            valid = readConfig(argv[++argId], options);
+        else if (option == "--trace" && hasValue)
+            Ctr::Trace::trace()->setDirectory(argv[++argId]);
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            LOG ("Unknown option or bad value " << option);
+            return false;
+        }
+    }
+
+    // Bundles hold the standard outputs, not the targets.
+    if (options.bundle && !options.targets.empty())
+    {
+        LOG ("--bundle cannot be combined with --target");
+        return false;
+    }
+
+    for (Ctr::RoughnessCurve curve : options.roughnessCurves)
+    {
+        if (curve == Ctr::RoughnessTable && options.roughnessTable.empty())
+        {
+            LOG ("The table roughness schedule needs --roughness-table or a RoughnessTable in --config");
+            return false;
+        }
+    }
+    if (options.roughnessCurves.empty())
+    {
+        options.roughnessCurves.push_back(options.roughnessTable.empty() ? Ctr::RoughnessLinear : Ctr::RoughnessTable);
+    }
+
+    // Bake at the largest target, the others are derived from it.
+    if (!options.targets.empty())
+    {
+        uint32_t specularResolution = 0;
+        uint32_t diffuseResolution = 0;
+        for (const Ctr::ExportTarget& target : options.targets)
+        {
+            specularResolution = std::max(specularResolution, target.specularResolution);
+            diffuseResolution = std::max(diffuseResolution, target.diffuseResolution);
+        }
+        iblBakeSetParameter(context, IBL_BAKE_SPECULAR_RESOLUTION, specularResolution);
+        iblBakeSetParameter(context, IBL_BAKE_DIFFUSE_RESOLUTION, diffuseResolution);
+    }
+
+    return !options.environmentPathName.empty() && !options.outputPathName.empty();
+}
+
+void
+printUsage()
+{
+    LOG ("iblbaker_cli: bakes specular, diffuse and brdf maps on the cpu, no gpu or window needed");
+    LOG ("  iblbaker_cli --environment <hdr or dds> --out <path/name> [options]");
+    LOG ("  --source-resolution <n>    Cube size for equirect sources, default 512.");
+    LOG ("  --specular-resolution <n>  Default 256.");
+    LOG ("  --diffuse-resolution <n>   Default 32.");
+    LOG ("  --samples <n>              Importance samples per texel, default 1024.");
+    LOG ("  --mip-drop <n>             Specular mips left off the end of the chain, default 0.");
+    LOG ("  --format <16|32>           HDR output format, default 32.");
+    LOG ("  --source-memory <MB>       Memory for resampling equirects, default 1024.");
+    LOG ("  --scale, --saturation, --hue  Environment scale and colour correction.");
+    LOG ("  --sh-roughness <r>         Specular mips from roughness r up are baked from SH, default 0.6, 2 for none.");
+    LOG ("                             Mips under 0.5 are always sampled.");
+    LOG ("  --seams <none|average|warp>  Seam fixup of the specular and diffuse maps, default average.");
+    LOG ("  --brdf <smith|schlick>     The .brdf the LUT and specular lods are computed for, default smith.");
+    LOG ("  --brdf-format <f>          rgba32f (default), rgba16f, or scale and bias only: rg32f, rg16f, rg16.");
+    LOG ("  --brdf-multiscatter <0|1>  Average albedo for multiple scattering in the LUT's blue channel.");
+    LOG ("  --roughness <s>[,<s>...]   Mip roughness schedule: linear (default), sqrt, unreal or table. With more");
+    LOG ("                             than one, a chain is baked for each from the one source, to <path/name>_<s>.");
+    LOG ("  --roughness-table <r...>   Roughness from the first specular mip to the last, e.g. \"0,0.2,0.5,1\".");
+    LOG ("  --target <name:spec:diff:enc>  Repeatable. Bakes once at the largest target and writes");
+    LOG ("                             <path/name>_<name>Specular*.dds and Diffuse*.dds for each, with enc");
+    LOG ("                             hdr16, hdr32, rgbm or rgbd, and one <path/name>Brdf.dds instead of the");
+    LOG ("                             standard outputs.");
+    LOG ("  --bundle <0|1>             Write <path/name>.zip holding the outputs and a manifest.json instead.");
+    LOG ("                             Not with --target.");
+    LOG ("  --config <xml>             Reads RoughnessSchedule and RoughnessTable from an iblBakerConfig.xml.");
+    LOG ("  --trace <dir>              Write a Chrome trace json of the bake to dir.");
+    LOG ("Outputs are named like the application's: <name>SpecularHDR.dds, <name>DiffuseMDR.dds, <name>Brdf.dds, ...");
+}
+}
+
+int main(int argc, char* argv[])
+{
+    IblBakeContext* context = iblBakeCreateContext();
+    CliOptions options;
+    if (!parseOptions(argc, argv, options, context))
+    {
+        printUsage();
+        iblBakeDestroyContext(context);
+        return 1;
+    }
+
+    size_t nameStart = options.environmentPathName.find_last_of("/\\");
+    nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+    std::string captureName = options.environmentPathName.substr(nameStart, options.environmentPathName.rfind('.') - nameStart);
+    Ctr::Trace::trace()->setThreadName("Main");
+    Ctr::Trace::trace()->begin(captureName.empty() ? std::string("bake") : captureName);
+
+    // The source is loaded once. After the first bake only the specular chain is
+    // stale when the schedule changes.
+    IblBakeResult result = iblBakeSetSourceFile(context, options.environmentPathName.c_str());
+    std::vector<IblBakeTarget> targets;
+    for (const Ctr::ExportTarget& target : options.targets)
+    {
+        IblBakeTarget bakeTarget = { target.name.c_str(), target.specularResolution, target.diffuseResolution,
+                                     IblBakeEncoding(target.encoding) };
+        targets.push_back(bakeTarget);
+    }
+    // Bundles hold the standard outputs, not the targets.
+    if (options.bundle && !options.targets.empty())
+    {
+        LOG ("--bundle cannot be combined with --target");
+        return false;
+    }
+
+    for (Ctr::RoughnessCurve curve : options.roughnessCurves)
+    {
+        std::string outputPathName = options.outputPathName;
+        if (options.roughnessCurves.size() > 1)
+            outputPathName += std::string("_") + Ctr::roughnessCurveName(curve);
+
+        if (result == IBL_BAKE_OK)
+            result = setRoughnessSchedule(context, curve, options.roughnessTable);
+        if (result == IBL_BAKE_OK)
+            result = iblBakeRun(context);
+        if (result == IBL_BAKE_OK && !targets.empty())
+            result = iblBakeWriteTargets(context, outputPathName.c_str(), &targets[0], uint32_t(targets.size()));
+        else if (result == IBL_BAKE_OK && options.bundle)
+            result = iblBakeWriteBundle(context, (outputPathName + ".zip").c_str());
+        else if (result == IBL_BAKE_OK)
+            result = iblBakeWriteFiles(context, outputPathName.c_str());
+    }
+    Ctr::Trace::trace()->end();
+    iblBakeDestroyContext(context);
+
+    if (result != IBL_BAKE_OK)
+    {
+        LOG ("Failed to bake " << options.environmentPathName << ": " << iblBakeResultString(result));
+        return 1;
+    }
+    LOG ("Baked " << options.environmentPathName << " to " << options.outputPathName);
+    return 0;
+}
@@ -0,0 +1,822 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblConvolution.h>
+#include <IblBrdf.h>
+#include <IblCubeMap.h>
+#include <IblParallel.h>
+#include <IblSeamFixup.h>
+#include <IblSphericalHarmonics.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <math.h>
+
+namespace Ctr
+{
+namespace
+{
+const float Pi = 3.14159265358979323f;
+
+// Sample in the tangent frame of the texel being convolved.
+struct ConvolutionSample
+{
+    float                      direction[3];
+    float                      weight;
+    float                      lod;
+};
+
+float
+dot3(const float* a, const float* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+void
+tangentFrame(const float* normal, float* tangentX, float* tangentY)
+{
+    float up[3] = { 0.0f, 0.0f, 1.0f };
+    if (fabsf(normal[2]) >= 0.999f)
+    {
+        up[0] = 1.0f;
+        up[2] = 0.0f;
+    }
+
+    tangentX[0] = up[1] * normal[2] - up[2] * normal[1];
+    tangentX[1] = up[2] * normal[0] - up[0] * normal[2];
+    tangentX[2] = up[0] * normal[1] - up[1] * normal[0];
+    float length = sqrtf(dot3(tangentX, tangentX));
+    tangentX[0] /= length;
+    tangentX[1] /= length;
+    tangentX[2] /= length;
+
+    tangentY[0] = normal[1] * tangentX[2] - normal[2] * tangentX[1];
+    tangentY[1] = normal[2] * tangentX[0] - normal[0] * tangentX[2];
+    tangentY[2] = normal[0] * tangentX[1] - normal[1] * tangentX[0];
+}
+
+void
+toWorld(const float* local, const float* tangentX, const float* tangentY, const float* normal, float* world)
+{
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        world[axis] = tangentX[axis] * local[0] + tangentY[axis] * local[1] + normal[axis] * local[2];
+    }
+}
+
+float
+sampleLod(float pdf, uint32_t sampleCount, uint32_t sourceSize)
+{
+    float solidAngleTexel = 4.0f * Pi / (6.0f * sourceSize * sourceSize);
+    float solidAngleSample = 1.0f / (sampleCount * pdf);
+    return 0.5f * log2f(solidAngleSample / solidAngleTexel);
+}
+
+// rescaleHDR in the importance sampling shaders.
+class Rescale
+{
+  public:
+    Rescale(const ConvolutionSettings& settings) :
+        _saturation(settings.saturation),
+        _scale(settings.environmentScale)
+    {
+        float halfAngle = 0.5f * settings.hue * Pi / 180.0f;
+        float axis = 0.57735f * sinf(halfAngle);
+        float quat[4] = { axis, axis, axis, cosf(halfAngle) };
+
+        float cross[3] = { quat[1] * quat[2], quat[2] * quat[0], quat[0] * quat[1] };
+        float square[3] = { quat[0] * quat[0], quat[1] * quat[1], quat[2] * quat[2] };
+        float wi[3] = { quat[3] * quat[0], quat[3] * quat[1], quat[3] * quat[2] };
+        float sum[3] = { square[0] + square[1], square[1] + square[2], square[2] + square[0] };
+        float diag[3] = { 0.5f - sum[0], 0.5f - sum[1], 0.5f - sum[2] };
+        float a[3] = { cross[0] + wi[0], cross[1] + wi[1], cross[2] + wi[2] };
+        float b[3] = { cross[0] - wi[0], cross[1] - wi[1], cross[2] - wi[2] };
+
+        float rows[3][3] = { { diag[0], b[2], a[1] },
+                             { a[2], diag[1], b[0] },
+                             { b[1], a[0], diag[2] } };
+        for (uint32_t row = 0; row < 3; row++)
+            for (uint32_t column = 0; column < 3; column++)
+                _hue[row][column] = 2.0f * rows[row][column];
+    }
+
+    void                       apply(float* rgb) const
+    {
+        float clamped[3] = { std::max(rgb[0], 0.0f), std::max(rgb[1], 0.0f), std::max(rgb[2], 0.0f) };
+        float intensity = clamped[0] * 0.299f + clamped[1] * 0.587f + clamped[2] * 0.114f;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            clamped[channel] = intensity + (clamped[channel] - intensity) * _saturation;
+        }
+        for (uint32_t row = 0; row < 3; row++)
+        {
+            rgb[row] = dot3(_hue[row], clamped) * _scale;
+        }
+    }
+
+  private:
+    float                      _saturation;
+    float                      _scale;
+    float                      _hue[3][3];
+};
+
+void
+convolveTexel(const CubeMap& source,
+              const std::vector<ConvolutionSample>& samples,
+              const Rescale& rescale,
+              const float* normal,
+              float* texel)
+{
+    float tangentX[3], tangentY[3];
+    tangentFrame(normal, tangentX, tangentY);
+
+    float result[4] = { 0, 0, 0, 0 };
+    for (const ConvolutionSample& sample : samples)
+    {
+        float direction[3], pixel[4];
+        toWorld(sample.direction, tangentX, tangentY, normal, direction);
+        source.sample(direction, sample.lod, pixel);
+        rescale.apply(pixel);
+
+        result[0] += pixel[0] * sample.weight;
+        result[1] += pixel[1] * sample.weight;
+        result[2] += pixel[2] * sample.weight;
+        result[3] += sample.weight;
+    }
+
+    float scale = result[3] > 0.0f ? 1.0f / result[3] : 1.0f;
+    texel[0] = result[0] * scale;
+    texel[1] = result[1] * scale;
+    texel[2] = result[2] * scale;
+    texel[3] = 1.0f;
+}
+
+// Texels [x0, x1) x [y0, y1) of one face and mip.
+void
+convolveRect(const CubeMap& source,
+             CubeMap& target,
+             uint32_t face,
+             uint32_t mip,
+             uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1,
+             const std::vector<ConvolutionSample>& samples,
+             const Rescale& rescale,
+             bool warpEdges)
+{
+    uint32_t size = target.mipSize(mip);
+    for (uint32_t y = y0; y < y1; y++)
+    {
+        float* texel = target.texels(face, mip) + (size_t(y) * size + x0) * 4;
+        for (uint32_t x = x0; x < x1; x++, texel += 4)
+        {
+            float normal[3];
+            cubeDirection(face,
+                          cubeTexelCoordinate(x, size, warpEdges),
+                          cubeTexelCoordinate(y, size, warpEdges),
+                          normal);
+            convolveTexel(source, samples, rescale, normal, texel);
+        }
+    }
+}
+
+void
+convolve(const CubeMap& source,
+         CubeMap& target,
+         uint32_t mip,
+         const std::vector<ConvolutionSample>& samples,
+         const ConvolutionSettings& settings)
+{
+    Rescale rescale(settings);
+    uint32_t size = target.mipSize(mip);
+    target.setWarpedEdges(settings.warpEdges);
+
+    parallelFor(6 * size, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t row = begin; row < end; row++)
+        {
+            convolveRect(source, target, row / size, mip, 0, row % size, size, row % size + 1,
+                         samples, rescale, settings.warpEdges);
+        }
+    });
+}
+
+// With N = V every sample's tangent space direction, weight and lod are the same for
+// all texels, so they are worked out once. Runs of samples that land on the same
+// direction and lod are merged into one with their summed weight. At roughness 0
+// every sample is the reflection of V, which makes mip 0 a single fetch per texel.
+template <class Brdf>
+void
+specularSamplesFor(const CubeMap& source,
+                   float roughness,
+                   uint32_t sampleCount,
+                   std::vector<ConvolutionSample>& samples)
+{
+    samples.clear();
+    samples.reserve(sampleCount);
+    const float normal[3] = { 0.0f, 0.0f, 1.0f };
+    for (uint32_t index = 0; index < sampleCount; index++)
+    {
+        float xi[2], halfVector[3];
+        hammersley(index, sampleCount, xi);
+        importanceSampleGGX(xi, roughness, normal, halfVector);
+
+        float VoH = halfVector[2];
+        ConvolutionSample sample;
+        sample.direction[0] = 2.0f * VoH * halfVector[0];
+        sample.direction[1] = 2.0f * VoH * halfVector[1];
+        sample.direction[2] = 2.0f * VoH * halfVector[2] - 1.0f;
+        sample.weight = std::max(sample.direction[2], 0.0f);
+        if (sample.weight <= 0.0f)
+        {
+            continue;
+        }
+
+        float NoH = std::max(halfVector[2], 0.0f);
+        float pdf = Brdf::distribution(roughness, NoH) * NoH / (4.0f * std::max(VoH, 0.0f));
+        sample.lod = roughness == 0.0f ? 0.0f : sampleLod(pdf, sampleCount, source.size());
+
+        if (!samples.empty())
+        {
+            ConvolutionSample& last = samples.back();
+            if (last.lod == sample.lod && last.direction[0] == sample.direction[0] &&
+                last.direction[1] == sample.direction[1] && last.direction[2] == sample.direction[2])
+            {
+                last.weight += sample.weight;
+                continue;
+            }
+        }
+        samples.push_back(sample);
+    }
+}
+
+// The BRDF is picked once per mip, the sample loop is the BRDF's own.
+void
+specularSamples(const CubeMap& source,
+                float roughness,
+                uint32_t sampleCount,
+                BrdfModel brdf,
+                std::vector<ConvolutionSample>& samples)
+{
+    switch (brdf)
+    {
+        case BrdfSchlick: specularSamplesFor<SchlickBrdf>(source, roughness, sampleCount, samples); break;
+        default: specularSamplesFor<SmithBrdf>(source, roughness, sampleCount, samples); break;
+    }
+}
+
+// Source mip the SH path projects, the bands kept need nothing finer.
+const uint32_t ShProjectionSize = 64;
+
+// The source as the convolution sees it, scale and colour correction included.
+void
+projectSource(const CubeMap& source, const ConvolutionSettings& settings, ShProjection& projection)
+{
+    uint32_t mip = 0;
+    while (mip + 1 < source.mipCount() && source.mipSize(mip) > ShProjectionSize)
+    {
+        mip++;
+    }
+
+    Rescale rescale(settings);
+    uint32_t size = source.mipSize(mip);
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        const float* texel = source.texels(face, mip);
+        for (uint32_t y = 0; y < size; y++)
+        {
+            for (uint32_t x = 0; x < size; x++, texel += 4)
+            {
+                float direction[3];
+                float rgb[3] = { texel[0], texel[1], texel[2] };
+                cubeDirection(face, (x + 0.5f) / size, (y + 0.5f) / size, direction);
+                rescale.apply(rgb);
+                projection.add(direction, rgb, cubeTexelSolidAngle(x, y, size));
+            }
+        }
+    }
+}
+
+void
+convolveSpecularSh(const ShProjection& projection,
+                   CubeMap& target,
+                   uint32_t mip,
+                   float roughness,
+                   const ConvolutionSettings& settings)
+{
+    IBL_TRACE_NAMED_SCOPE(mipScope, "SH mip", "compute");
+    IBL_TRACE_ARG(mipScope, 0, "mip", mip);
+    IBL_TRACE_ARG(mipScope, 1, "roughness", roughness);
+
+    float lobe[ShBandCount];
+    ggxLobeCoefficients(roughness, ShBandCount, lobe);
+    uint32_t size = target.mipSize(mip);
+    target.setWarpedEdges(settings.warpEdges);
+
+    parallelFor(6 * size, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t row = begin; row < end; row++)
+        {
+            uint32_t face = row / size;
+            uint32_t y = row % size;
+            float* texel = target.texels(face, mip) + size_t(y) * size * 4;
+            for (uint32_t x = 0; x < size; x++, texel += 4)
+            {
+                float normal[3];
+                cubeDirection(face,
+                              cubeTexelCoordinate(x, size, settings.warpEdges),
+                              cubeTexelCoordinate(y, size, settings.warpEdges),
+                              normal);
+                shEvaluate(projection, lobe, normal, texel);
+                // Truncated bands can ring below zero around very bright sources.
+                texel[0] = std::max(texel[0], 0.0f);
+                texel[1] = std::max(texel[1], 0.0f);
+                texel[2] = std::max(texel[2], 0.0f);
+                texel[3] = 1.0f;
+            }
+        }
+    });
+}
+
+// Roughness of a mip of the specular chain.
+float
+chainRoughness(const CubeMap& target, uint32_t mip, const ConvolutionSettings& settings)
+{
+    return settings.roughnessSchedule.roughness(mip, target.mipCount(), target.size());
+}
+
+// First mip of the chain the SH path takes over from. Schedules never decrease.
+uint32_t
+firstShMip(const CubeMap& target, const ConvolutionSettings& settings)
+{
+    float shRoughness = std::max(settings.shRoughness, ShMinRoughness);
+    uint32_t mip = 0;
+    while (mip < target.mipCount() && chainRoughness(target, mip, settings) < shRoughness)
+    {
+        mip++;
+    }
+    return mip;
+}
+
+// Mips from firstMip on, by projection. mips, if not empty, flags the ones to do.
+void
+convolveSpecularChainSh(const CubeMap& source,
+                        CubeMap& target,
+                        uint32_t firstMip,
+                        const ConvolutionSettings& settings,
+                        const std::vector<bool>& mips)
+{
+    uint32_t mip = firstMip;
+    while (mip < target.mipCount() && !mips.empty() && !mips[mip])
+    {
+        mip++;
+    }
+    if (mip >= target.mipCount())
+    {
+        return;
+    }
+
+    ShProjection projection;
+    {
+        IBL_TRACE_SCOPE("SH projection", "compute");
+        projectSource(source, settings, projection);
+    }
+    for (; mip < target.mipCount(); mip++)
+    {
+        if (mips.empty() || mips[mip])
+        {
+            convolveSpecularSh(projection, target, mip, chainRoughness(target, mip, settings), settings);
+        }
+    }
+}
+
+void
+setChainRoughness(CubeMap& target, const ConvolutionSettings& settings)
+{
+    std::vector<float> mipRoughness(target.mipCount());
+    for (uint32_t mip = 0; mip < target.mipCount(); mip++)
+    {
+        mipRoughness[mip] = chainRoughness(target, mip, settings);
+    }
+    target.setMipRoughness(mipRoughness);
+}
+
+// The chain a tile at a time: every mip with at least a texel per tile is convolved
+// for one region of the face before moving on to the next. The lobes of neighbouring
+// mips fetch from overlapping texels of the source's mips, which are then still in
+// cache. Mips too small to split into tiles are convolved on their own afterwards.
+void
+convolveSpecularChainInterleaved(const CubeMap& source,
+                                 CubeMap& target,
+                                 uint32_t sampleCount,
+                                 const ConvolutionSettings& settings)
+{
+    const uint32_t TileSize = 16;
+    uint32_t tiles = std::max(target.size() / TileSize, 1u);
+    uint32_t shMip = firstShMip(target, settings);
+    std::vector<std::vector<ConvolutionSample> > samples(shMip);
+    for (uint32_t mip = 0; mip < shMip; mip++)
+    {
+        specularSamples(source, chainRoughness(target, mip, settings), sampleCount, settings.brdf, samples[mip]);
+    }
+
+    uint32_t tiledMips = 0;
+    size_t tiledSamples = 0;
+    while (tiledMips < shMip && target.mipSize(tiledMips) >= tiles)
+    {
+        tiledSamples += samples[tiledMips].size();
+        tiledMips++;
+    }
+
+    // The tiled mips share one pass, so they share a scope.
+    {
+        IBL_TRACE_NAMED_SCOPE(tilesScope, "Convolve tiled mips", "compute");
+        IBL_TRACE_ARG(tilesScope, 0, "mips", tiledMips);
+        IBL_TRACE_ARG(tilesScope, 1, "samples", tiledSamples);
+        Rescale rescale(settings);
+        target.setWarpedEdges(settings.warpEdges);
+        parallelFor(6 * tiles * tiles, [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t tile = begin; tile < end; tile++)
+            {
+                uint32_t face = tile / (tiles * tiles);
+                uint32_t tileX = tile % tiles;
+                uint32_t tileY = (tile / tiles) % tiles;
+                for (uint32_t mip = 0; mip < tiledMips; mip++)
+                {
+                    uint32_t size = target.mipSize(mip);
+                    convolveRect(source, target, face, mip,
+                                 tileX * size / tiles, tileY * size / tiles,
+                                 (tileX + 1) * size / tiles, (tileY + 1) * size / tiles,
+                                 samples[mip], rescale, settings.warpEdges);
+                }
+            }
+        });
+    }
+
+    for (uint32_t mip = tiledMips; mip < shMip; mip++)
+    {
+        IBL_TRACE_NAMED_SCOPE(mipScope, "Convolve mip", "compute");
+        IBL_TRACE_ARG(mipScope, 0, "mip", mip);
+        IBL_TRACE_ARG(mipScope, 1, "roughness", chainRoughness(target, mip, settings));
+        IBL_TRACE_ARG(mipScope, 2, "samples", samples[mip].size());
+        convolve(source, target, mip, samples[mip], settings);
+    }
+    convolveSpecularChainSh(source, target, shMip, settings, std::vector<bool>());
+}
+
+// IblBrdf.hlsl with the terms of Brdf.
+template <class Brdf>
+void
+brdfLut(uint32_t size, uint32_t sampleCount, bool multiScatter, float* rgba)
+{
+    parallelFor(size, [&](uint32_t begin, uint32_t end)
+    {
+        const float normal[3] = { 0.0f, 0.0f, 1.0f };
+        for (uint32_t y = begin; y < end; y++)
+        {
+            float roughness = (y + 0.5f) / size;
+            float* row = rgba + size_t(size - 1 - y) * size * 4;
+
+            for (uint32_t x = 0; x < size; x++)
+            {
+                float NoV = (x + 0.5f) / size;
+                float view[3] = { sqrtf(1.0f - NoV * NoV), 0.0f, NoV };
+                float visibility = Brdf::visibility(roughness, NoV);
+                float result[2] = { 0.0f, 0.0f };
+
+                for (uint32_t index = 0; index < sampleCount; index++)
+                {
+                    float xi[2], halfVector[3];
+                    hammersley(index, sampleCount, xi);
+                    importanceSampleGGX(xi, roughness, normal, halfVector);
+
+                    float VoH = dot3(view, halfVector);
+                    float light[3] = { 2.0f * VoH * halfVector[0] - view[0],
+                                       2.0f * VoH * halfVector[1] - view[1],
+                                       2.0f * VoH * halfVector[2] - view[2] };
+
+                    float NoL = std::min(std::max(light[2], 0.0f), 1.0f);
+                    float NoH = std::min(std::max(halfVector[2], 0.0f), 1.0f);
+                    VoH = std::min(std::max(VoH, 0.0f), 1.0f);
+                    if (NoL > 0.0f)
+                    {
+                        float G = Brdf::geometry(roughness, NoL) * visibility;
+                        float F = Brdf::fresnel(VoH);
+                        float GVis = G * VoH / (NoH * NoV);
+                        result[0] += (1.0f - F) * GVis;
+                        result[1] += F * GVis;
+                    }
+                }
+
+                row[x * 4 + 0] = result[0] / sampleCount;
+                row[x * 4 + 1] = result[1] / sampleCount;
+                row[x * 4 + 2] = roughness;
+                row[x * 4 + 3] = 1.0f;
+            }
+
+            // The row holds E(NoV) = scale + bias for one roughness, which is all the
+            // cosine weighted average needs.
+            if (multiScatter)
+            {
+                float average = 0.0f;
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    average += (row[x * 4 + 0] + row[x * 4 + 1]) * (x + 0.5f) / size;
+                }
+                average *= 2.0f / size;
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    row[x * 4 + 2] = average;
+                }
+            }
+        }
+    });
+}
+}
+
+ConvolutionSettings::ConvolutionSettings() :
+    environmentScale(1.0f),
+    saturation(1.0f),
+    hue(0.0f),
+    warpEdges(false),
+    interleaveMips(false),
+    shRoughness(0.6f),
+    brdf(BrdfSmith),
+    roughnessSchedule()
+{
+}
+
+float
+radicalInverse(uint32_t bits)
+{
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return float(bits) * 2.3283064365386963e-10f;
+}
+
+void
+hammersley(uint32_t index, uint32_t sampleCount, float* xi)
+{
+    xi[0] = float(index) / float(sampleCount);
+    xi[1] = radicalInverse(index);
+}
+
+void
+importanceSampleGGX(const float* xi, float roughness, const float* normal, float* halfVector)
+{
+    float a = roughness * roughness;
+    float phi = 2.0f * Pi * xi[0];
+    float cosTheta = sqrtf((1.0f - xi[1]) / (1.0f + (a * a - 1.0f) * xi[1]));
+    float sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+    float local[3] = { sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta };
+
+    float tangentX[3], tangentY[3];
+    tangentFrame(normal, tangentX, tangentY);
+    toWorld(local, tangentX, tangentY, normal, halfVector);
+}
+
+void
+importanceSampleDiffuse(const float* xi, const float* normal, float* halfVector)
+{
+    float cosTheta = 1.0f - xi[1];
+    float sinTheta = sqrtf(1.0f - cosTheta * cosTheta);
+    float phi = 2.0f * Pi * xi[0];
+    float local[3] = { sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta };
+
+    float tangentX[3], tangentY[3];
+    tangentFrame(normal, tangentX, tangentY);
+    toWorld(local, tangentX, tangentY, normal, halfVector);
+}
+
+float
+specularD(float roughness, float NoH)
+{
+    return SmithBrdf::distribution(roughness, NoH);
+}
+
+float
+specularMipRoughness(uint32_t mip, uint32_t mipCount)
+{
+    return mipCount > 1 ? float(mip) / float(mipCount - 1) : 0.0f;
+}
+
+void
+convolveSpecular(const CubeMap& source,
+                 CubeMap& target,
+                 uint32_t mip,
+                 float roughness,
+                 uint32_t sampleCount,
+                 const ConvolutionSettings& settings)
+{
+    // Samples are the merged count, what the convolution actually fetches.
+    IBL_TRACE_NAMED_SCOPE(mipScope, "Convolve mip", "compute");
+    std::vector<ConvolutionSample> samples;
+    specularSamples(source, roughness, sampleCount, settings.brdf, samples);
+    IBL_TRACE_ARG(mipScope, 0, "mip", mip);
+    IBL_TRACE_ARG(mipScope, 1, "roughness", roughness);
+    IBL_TRACE_ARG(mipScope, 2, "samples", samples.size());
+    convolve(source, target, mip, samples, settings);
+}
+
+void
+convolveSpecularChain(const CubeMap& source,
+                      CubeMap& target,
+                      uint32_t sampleCount,
+                      const ConvolutionSettings& settings)
+{
+    setChainRoughness(target, settings);
+    if (settings.interleaveMips)
+    {
+        convolveSpecularChainInterleaved(source, target, sampleCount, settings);
+        return;
+    }
+
+    uint32_t shMip = firstShMip(target, settings);
+    for (uint32_t mip = 0; mip < shMip; mip++)
+    {
+        convolveSpecular(source, target, mip, chainRoughness(target, mip, settings), sampleCount, settings);
+    }
+    convolveSpecularChainSh(source, target, shMip, settings, std::vector<bool>());
+}
+
+void
+convolveSpecularChain(const CubeMap& source,
+                      CubeMap& target,
+                      uint32_t sampleCount,
+                      const ConvolutionSettings& settings,
+                      const std::vector<bool>& mips)
+{
+    setChainRoughness(target, settings);
+    uint32_t shMip = firstShMip(target, settings);
+    for (uint32_t mip = 0; mip < shMip; mip++)
+    {
+        if (mips[mip])
+        {
+            convolveSpecular(source, target, mip, chainRoughness(target, mip, settings), sampleCount, settings);
+        }
+    }
+    convolveSpecularChainSh(source, target, shMip, settings, mips);
+}
+
+float
+specularShErrorBound(const CubeMap& source, float roughness, const ConvolutionSettings& settings)
+{
+    ShProjection projection;
+    projectSource(source, settings, projection);
+    return shLobeErrorBound(projection, roughness);
+}
+
+void
+convolveDiffuse(const CubeMap& source,
+                CubeMap& target,
+                uint32_t sampleCount,
+                const ConvolutionSettings& settings)
+{
+    // The diffuse shader samples along H, not L, and weights every sample equally.
+    std::vector<ConvolutionSample> samples;
+    samples.reserve(sampleCount);
+    const float normal[3] = { 0.0f, 0.0f, 1.0f };
+    for (uint32_t index = 0; index < sampleCount; index++)
+    {
+        float xi[2], halfVector[3];
+        hammersley(index, sampleCount, xi);
+        importanceSampleDiffuse(xi, normal, halfVector);
+
+        float VoH = halfVector[2];
+        float light[3] = { 2.0f * VoH * halfVector[0], 2.0f * VoH * halfVector[1], 2.0f * VoH * halfVector[2] - 1.0f };
+        float NoL = std::min(std::max(light[2] / sqrtf(dot3(light, light)), 0.0f), 1.0f);
+        if (NoL <= 0.0f)
+        {
+            continue;
+        }
+
+        ConvolutionSample sample;
+        memcpy(sample.direction, halfVector, sizeof(sample.direction));
+        sample.weight = 1.0f;
+        sample.lod = sampleLod(NoL / Pi, sampleCount, source.size());
+        samples.push_back(sample);
+    }
+
+    convolve(source, target, 0, samples, settings);
+}
+
+void
+computeBrdfLut(uint32_t size, uint32_t sampleCount, BrdfModel brdf, bool multiScatter, float* rgba)
+{
+    switch (brdf)
+    {
+        case BrdfSchlick: brdfLut<SchlickBrdf>(size, sampleCount, multiScatter, rgba); break;
+        default: brdfLut<SmithBrdf>(size, sampleCount, multiScatter, rgba); break;
+    }
+}
+
+void
+encodeRgbm(const float* rgba, uint8_t* rgbm, size_t texelCount)
+{
+    for (size_t texel = 0; texel < texelCount; texel++, rgba += 4, rgbm += 4)
+    {
+        float color[3];
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            color[channel] = powf(std::max(rgba[channel], 0.0f), 1.0f / 2.2f) / 5.0f;
+        }
+
+        float multiplier = std::min(std::max(std::max(color[0], color[1]), std::max(color[2], 1e-6f)), 1.0f);
+        multiplier = ceilf(multiplier * 255.0f) / 255.0f;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            rgbm[channel] = uint8_t(std::min(color[channel] / multiplier, 1.0f) * 255.0f + 0.5f);
+        }
+        rgbm[3] = uint8_t(multiplier * 255.0f + 0.5f);
+    }
+}
+
+void
+decodeRgbm(const uint8_t* rgbm, float* rgba, size_t texelCount)
+{
+    for (size_t texel = 0; texel < texelCount; texel++, rgbm += 4, rgba += 4)
+    {
+        float multiplier = rgbm[3] / 255.0f * 5.0f;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            rgba[channel] = powf(rgbm[channel] / 255.0f * multiplier, 2.2f);
+        }
+        rgba[3] = 1.0f;
+    }
+}
+
+void
+encodeRgbd(const float* rgba, uint8_t* rgbd, size_t texelCount)
+{
+    for (size_t texel = 0; texel < texelCount; texel++, rgba += 4, rgbd += 4)
+    {
+        float color[3];
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            color[channel] = powf(std::max(rgba[channel], 0.0f), 1.0f / 2.2f);
+        }
+
+        // The largest divisor that keeps the brightest channel in range, in 1/255 steps.
+        float maximum = std::max(std::max(color[0], color[1]), std::max(color[2], 1e-6f));
+        float divisor = std::min(std::max(floorf(std::max(255.0f / maximum, 1.0f)) / 255.0f, 1.0f / 255.0f), 1.0f);
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            rgbd[channel] = uint8_t(std::min(color[channel] * divisor, 1.0f) * 255.0f + 0.5f);
+        }
+        rgbd[3] = uint8_t(divisor * 255.0f + 0.5f);
+    }
+}
+
+void
+decodeRgbd(const uint8_t* rgbd, float* rgba, size_t texelCount)
+{
+    for (size_t texel = 0; texel < texelCount; texel++, rgbd += 4, rgba += 4)
+    {
+        float divisor = std::max(rgbd[3], uint8_t(1)) / 255.0f;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            rgba[channel] = powf(rgbd[channel] / 255.0f / divisor, 2.2f);
+        }
+        rgba[3] = 1.0f;
+    }
+}
+}
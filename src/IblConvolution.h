@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_CONVOLUTION
+#define INCLUDED_IBL_CONVOLUTION
+
+#include <IblPlatform.h>
+#include <IblBrdf.h>
+#include <IblRoughnessSchedule.h>
+
+namespace Ctr
+{
+class CubeMap;
+
+//------------------------------------------------------------------------------------//
+// Cpu versions of the probe shaders: IblImportanceSamplingSpecular.fx,               //
+// IblImportanceSamplingDiffuse.fx, IblBrdf.hlsl with the .brdf files (IblBrdf.h),    //
+// and the RGBM path of IblColorConvertEnvironment.fx. They produce the same result   //
+// the progressive gpu bake converges to, all samples in one pass. The bench and      //
+// verification tools use them, so a change to the shader math has to be made here as //
+// well. The roughest specular mips are the exception, they come from an SH           //
+// projection by default.                                                             //
+//------------------------------------------------------------------------------------//
+struct ConvolutionSettings
+{
+    ConvolutionSettings();
+
+    // IBLSOURCEENVIRONMENTSCALE and IBLCORRECTION.yz.
+    float                      environmentScale;
+    float                      saturation;
+    float                      hue;
+
+    // Convolve in the stretched texel directions of SeamFixupWarp.
+    bool                       warpEdges;
+    // convolveSpecularChain convolves the mips a tile at a time instead of one after
+    // the other. Same results, compare specular_interleaved with specular in
+    // iblbaker_bench before turning it on.
+    bool                       interleaveMips;
+    // convolveSpecularChain bakes the mips from this roughness up from an SH
+    // projection of the source instead of by sampling, see IblSphericalHarmonics.h.
+    // Above 1 turns it off. Mips under ShMinRoughness are sampled whatever it is.
+    float                      shRoughness;
+    // The .brdf the probe shader would include, its D sets the lod of the specular
+    // samples.
+    BrdfModel                  brdf;
+    // Roughness of each mip convolveSpecularChain bakes, recorded in the target.
+    RoughnessSchedule          roughnessSchedule;
+};
+
+// Below this the 9 band lobe is too far off the GGX one: at 0.5 the SH mips are
+// about 1% off in luminance against 8192 samples, at 0.33 15%, at 0.17 70%.
+const float                    ShMinRoughness = 0.5f;
+
+float                          radicalInverse(uint32_t bits);
+void                           hammersley(uint32_t index, uint32_t sampleCount, float* xi);
+void                           importanceSampleGGX(const float* xi, float roughness, const float* normal, float* halfVector);
+void                           importanceSampleDiffuse(const float* xi, const float* normal, float* halfVector);
+// specularD of smith.brdf.
+float                          specularD(float roughness, float NoH);
+
+// The probe's roughness for a specular mip, the linear RoughnessSchedule.
+float                          specularMipRoughness(uint32_t mip, uint32_t mipCount);
+
+// source needs its mips, samples are filtered from them by pdf.
+void                           convolveSpecular(const CubeMap& source,
+                                                CubeMap& target,
+                                                uint32_t mip,
+                                                float roughness,
+                                                uint32_t sampleCount,
+                                                const ConvolutionSettings& settings);
+void                           convolveSpecularChain(const CubeMap& source,
+                                                     CubeMap& target,
+                                                     uint32_t sampleCount,
+                                                     const ConvolutionSettings& settings);
+// Only the mips flagged in mips, one per mip of target, the others are left as they
+// are. The mip roughness is set for all of them.
+void                           convolveSpecularChain(const CubeMap& source,
+                                                     CubeMap& target,
+                                                     uint32_t sampleCount,
+                                                     const ConvolutionSettings& settings,
+                                                     const std::vector<bool>& mips);
+// Relative RMS error bound of the SH path at a roughness, see shLobeErrorBound.
+float                          specularShErrorBound(const CubeMap& source,
+                                                    float roughness,
+                                                    const ConvolutionSettings& settings);
+
+void                           convolveDiffuse(const CubeMap& source,
+                                               CubeMap& target,
+                                               uint32_t sampleCount,
+                                               const ConvolutionSettings& settings);
+
+// size * size RGBA32F texels: scale, bias, roughness, 1. Roughness goes up the rows.
+// With multiScatter the roughness is replaced by the cosine weighted average of
+// scale + bias over NoV, the Eavg of multiple scattering compensation
+// (Kulla and Conty 2017). It comes out of the same pass, so a runtime gets E and
+// Eavg from one fetch.
+void                           computeBrdfLut(uint32_t size,
+                                              uint32_t sampleCount,
+                                              BrdfModel brdf,
+                                              bool multiScatter,
+                                              float* rgba);
+
+// Gamma 2.2 and RGBM with a range of 5, as the MDR outputs are written.
+void                           encodeRgbm(const float* rgba, uint8_t* rgbm, size_t texelCount);
+void                           decodeRgbm(const uint8_t* rgbm, float* rgba, size_t texelCount);
+// Gamma 2.2 and RGBD: rgb / d with d in 1/255 steps, up to 255 in gamma space.
+void                           encodeRgbd(const float* rgba, uint8_t* rgbd, size_t texelCount);
+void                           decodeRgbd(const uint8_t* rgbd, float* rgba, size_t texelCount);
+}
+
+#endif
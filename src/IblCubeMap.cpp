@@ -0,0 +1,354 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblCubeMap.h>
+#include <IblDds.h>
+#include <IblHalf.h>
+#include <algorithm>
+#include <math.h>
+
+namespace Ctr
+{
+void
+cubeDirection(uint32_t face, float u, float v, float* direction)
+{
+    float sc = 2.0f * u - 1.0f;
+    float tc = 2.0f * v - 1.0f;
+    float x, y, z;
+
+    switch (face)
+    {
+        case 0: x = 1.0f; y = -tc; z = -sc; break;
+        case 1: x = -1.0f; y = -tc; z = sc; break;
+        case 2: x = sc; y = 1.0f; z = tc; break;
+        case 3: x = sc; y = -1.0f; z = -tc; break;
+        case 4: x = sc; y = -tc; z = 1.0f; break;
+        default: x = -sc; y = -tc; z = -1.0f; break;
+    }
+
+    float length = sqrtf(x * x + y * y + z * z);
+    direction[0] = x / length;
+    direction[1] = y / length;
+    direction[2] = z / length;
+}
+
+void
+cubeFaceCoordinates(const float* direction, uint32_t& face, float& u, float& v)
+{
+    float x = direction[0];
+    float y = direction[1];
+    float z = direction[2];
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float az = fabsf(z);
+    float sc, tc, ma;
+
+    if (ax >= ay && ax >= az)
+    {
+        ma = ax;
+        face = x > 0 ? 0 : 1;
+        sc = x > 0 ? -z : z;
+        tc = -y;
+    }
+    else if (ay >= az)
+    {
+        ma = ay;
+        face = y > 0 ? 2 : 3;
+        sc = x;
+        tc = y > 0 ? z : -z;
+    }
+    else
+    {
+        ma = az;
+        face = z > 0 ? 4 : 5;
+        sc = z > 0 ? x : -x;
+        tc = -y;
+    }
+
+    u = 0.5f * (sc / ma + 1.0f);
+    v = 0.5f * (tc / ma + 1.0f);
+}
+
+uint32_t
+cubeMipCount(uint32_t size)
+{
+    uint32_t mipCount = 1;
+    while (size > 1)
+    {
+        size >>= 1;
+        mipCount++;
+    }
+    return mipCount;
+}
+
+void
+downsampleSurface(const float* source, uint32_t sourceSize, float* target)
+{
+    uint32_t targetSize = std::max(sourceSize / 2, 1u);
+    for (uint32_t y = 0; y < targetSize; y++)
+    {
+        for (uint32_t x = 0; x < targetSize; x++)
+        {
+            const float* row0 = source + (size_t(y * 2) * sourceSize + x * 2) * 4;
+            const float* row1 = sourceSize > 1 ? row0 + size_t(sourceSize) * 4 : row0;
+            size_t step = sourceSize > 1 ? 4 : 0;
+            for (uint32_t channel = 0; channel < 4; channel++)
+            {
+                target[(size_t(y) * targetSize + x) * 4 + channel] =
+                    0.25f * (row0[channel] + row0[channel + step] + row1[channel] + row1[channel + step]);
+            }
+        }
+    }
+}
+
+CubeMap::CubeMap() :
+    _size(0),
+    _mipCount(0),
+    _faceSize(0),
+    _warpedEdges(false)
+{
+}
+
+CubeMap::CubeMap(uint32_t size, uint32_t mipCount) :
+    _size(0),
+    _mipCount(0),
+    _faceSize(0),
+    _warpedEdges(false)
+{
+    create(size, mipCount);
+}
+
+void
+CubeMap::create(uint32_t size, uint32_t mipCount)
+{
+    _size = size;
+    _mipCount = std::max(1u, std::min(mipCount, cubeMipCount(size)));
+    _mipOffsets.resize(_mipCount);
+
+    _faceSize = 0;
+    for (uint32_t mip = 0; mip < _mipCount; mip++)
+    {
+        _mipOffsets[mip] = _faceSize;
+        _faceSize += size_t(mipSize(mip)) * mipSize(mip) * 4;
+    }
+    _texels.assign(_faceSize * 6, 0.0f);
+    _warpedEdges = false;
+    _mipRoughness.clear();
+}
+
+uint32_t
+CubeMap::size() const
+{
+    return _size;
+}
+
+uint32_t
+CubeMap::mipSize(uint32_t mip) const
+{
+    return std::max(_size >> mip, 1u);
+}
+
+uint32_t
+CubeMap::mipCount() const
+{
+    return _mipCount;
+}
+
+float*
+CubeMap::texels(uint32_t face, uint32_t mip)
+{
+    return &_texels[face * _faceSize + _mipOffsets[mip]];
+}
+
+const float*
+CubeMap::texels(uint32_t face, uint32_t mip) const
+{
+    return &_texels[face * _faceSize + _mipOffsets[mip]];
+}
+
+void
+CubeMap::generateMips()
+{
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t mip = 1; mip < _mipCount; mip++)
+        {
+            downsampleSurface(texels(face, mip - 1), mipSize(mip - 1), texels(face, mip));
+        }
+    }
+}
+
+bool
+CubeMap::warpedEdges() const
+{
+    return _warpedEdges;
+}
+
+void
+CubeMap::setWarpedEdges(bool warpedEdges)
+{
+    _warpedEdges = warpedEdges;
+}
+
+const std::vector<float>&
+CubeMap::mipRoughness() const
+{
+    return _mipRoughness;
+}
+
+void
+CubeMap::setMipRoughness(const std::vector<float>& mipRoughness)
+{
+    _mipRoughness = mipRoughness;
+}
+
+void
+CubeMap::sampleBilinear(uint32_t face, uint32_t mip, float u, float v, float* rgba) const
+{
+    uint32_t size = mipSize(mip);
+    const float* faceTexels = texels(face, mip);
+
+    // Warped texel centres run from 0 to 1 instead of half a texel in.
+    float scale = _warpedEdges ? float(size - 1) : float(size);
+    float bias = _warpedEdges ? 0.0f : 0.5f;
+    float x = std::min(std::max(u * scale - bias, 0.0f), float(size - 1));
+    float y = std::min(std::max(v * scale - bias, 0.0f), float(size - 1));
+    uint32_t x0 = uint32_t(x);
+    uint32_t y0 = uint32_t(y);
+    uint32_t x1 = std::min(x0 + 1, size - 1);
+    uint32_t y1 = std::min(y0 + 1, size - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    const float* t00 = faceTexels + (size_t(y0) * size + x0) * 4;
+    const float* t10 = faceTexels + (size_t(y0) * size + x1) * 4;
+    const float* t01 = faceTexels + (size_t(y1) * size + x0) * 4;
+    const float* t11 = faceTexels + (size_t(y1) * size + x1) * 4;
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        float top = t00[channel] + (t10[channel] - t00[channel]) * fx;
+        float bottom = t01[channel] + (t11[channel] - t01[channel]) * fx;
+        rgba[channel] = top + (bottom - top) * fy;
+    }
+}
+
+void
+CubeMap::sample(const float* direction, float lod, float* rgba) const
+{
+    uint32_t face;
+    float u, v;
+    cubeFaceCoordinates(direction, face, u, v);
+
+    lod = std::min(std::max(lod, 0.0f), float(_mipCount - 1));
+    uint32_t mip0 = uint32_t(lod);
+    uint32_t mip1 = std::min(mip0 + 1, _mipCount - 1);
+    float blend = lod - mip0;
+
+    sampleBilinear(face, mip0, u, v, rgba);
+    if (blend > 0.0f && mip1 != mip0)
+    {
+        float upper[4];
+        sampleBilinear(face, mip1, u, v, upper);
+        for (uint32_t channel = 0; channel < 4; channel++)
+        {
+            rgba[channel] += (upper[channel] - rgba[channel]) * blend;
+        }
+    }
+}
+
+bool
+CubeMap::load(const std::string& filePathName)
+{
+    DdsView view;
+    if (!view.open(filePathName))
+    {
+        return false;
+    }
+
+    const DdsDescription& description = view.description();
+    if (description.faceCount != 6 || description.width != description.height ||
+        (description.format != DdsRgba32f && description.format != DdsRgba16f))
+    {
+        LOG (filePathName << " is not a float cube map");
+        return false;
+    }
+
+    create(description.width, description.mipCount);
+    _warpedEdges = (description.flags & DdsFlagWarpedEdges) != 0;
+    _mipRoughness = description.mipRoughness;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t mip = 0; mip < _mipCount; mip++)
+        {
+            size_t count = size_t(mipSize(mip)) * mipSize(mip) * 4;
+            if (description.format == DdsRgba32f)
+            {
+                memcpy(texels(face, mip), view.surface(face, mip), count * sizeof(float));
+            }
+            else
+            {
+                halfToFloat((const uint16_t*)view.surface(face, mip), texels(face, mip), count);
+            }
+        }
+    }
+    return true;
+}
+
+bool
+CubeMap::save(const DdsDestination& destination, DdsFormat format) const
+{
+    DdsDescription description(_size, _size, _mipCount, 6, format, _warpedEdges ? DdsFlagWarpedEdges : 0);
+    description.mipRoughness = _mipRoughness;
+    if (format == DdsRgba32f)
+    {
+        return writeDds(destination, description, &_texels[0]);
+    }
+    if (format != DdsRgba16f)
+    {
+        LOG ("Cube maps are saved as RGBA16F or RGBA32F");
+        return false;
+    }
+
+    std::vector<uint16_t> halfs(_texels.size());
+    floatToHalf(&_texels[0], &halfs[0], _texels.size());
+    return writeDds(destination, description, &halfs[0]);
+}
+}
@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_CUBE_MAP
+#define INCLUDED_IBL_CUBE_MAP
+
+#include <IblPlatform.h>
+#include <IblDds.h>
+
+namespace Ctr
+{
+// Faces follow D3D: +X, -X, +Y, -Y, +Z, -Z. u and v are in [0, 1] across a face.
+void                           cubeDirection(uint32_t face, float u, float v, float* direction);
+void                           cubeFaceCoordinates(const float* direction, uint32_t& face, float& u, float& v);
+
+// Mips down to 1x1.
+uint32_t                       cubeMipCount(uint32_t size);
+
+// 2x2 box filter of a sourceSize square RGBA32F surface into one half the size.
+void                           downsampleSurface(const float* source, uint32_t sourceSize, float* target);
+
+//------------------------------------------------------------------------------------//
+// RGBA32F cube map in system memory, the cpu side counterpart of the probe's cube    //
+// targets. Texels are face major with mips inside each face, the same layout as a    //
+// dds, so load and save are straight copies.                                         //
+//------------------------------------------------------------------------------------//
+class CubeMap
+{
+  public:
+    CubeMap();
+    CubeMap(uint32_t size, uint32_t mipCount);
+
+    void                       create(uint32_t size, uint32_t mipCount);
+
+    uint32_t                   size() const;
+    uint32_t                   mipSize(uint32_t mip) const;
+    uint32_t                   mipCount() const;
+
+    float*                     texels(uint32_t face, uint32_t mip);
+    const float*               texels(uint32_t face, uint32_t mip) const;
+
+    // Box filters each mip from the one above it.
+    void                       generateMips();
+
+    // Texels convolved in warped directions (SeamFixupWarp). Sampling undoes the
+    // stretch, and save and load keep the flag in the dds. create clears it.
+    bool                       warpedEdges() const;
+    void                       setWarpedEdges(bool warpedEdges);
+    // Roughness each mip was convolved with, empty if not convolved. Kept in the dds
+    // like the warp flag, create clears it.
+    const std::vector<float>&  mipRoughness() const;
+    void                       setMipRoughness(const std::vector<float>& mipRoughness);
+
+    // Clamps at face edges, there is no filtering across faces.
+    void                       sampleBilinear(uint32_t face, uint32_t mip, float u, float v, float* rgba) const;
+    // Trilinear, like SampleLevel on a cube.
+    void                       sample(const float* direction, float lod, float* rgba) const;
+
+    // Loads RGBA16F or RGBA32F cube dds files.
+    bool                       load(const std::string& filePathName);
+    bool                       save(const DdsDestination& destination, DdsFormat format = DdsRgba32f) const;
+
+  private:
+    uint32_t                   _size;
+    uint32_t                   _mipCount;
+    size_t                     _faceSize;
+    std::vector<size_t>        _mipOffsets;
+    std::vector<float>         _texels;
+    bool                       _warpedEdges;
+    std::vector<float>         _mipRoughness;
+};
+}
+
+#endif
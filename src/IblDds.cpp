@@ -0,0 +1,574 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblDds.h>
+#include <algorithm>
+
+namespace Ctr
+{
+namespace
+{
+const uint32_t DdsMagic = 0x20534444; // "DDS "
+
+const uint32_t DDSD_CAPS = 0x1;
+const uint32_t DDSD_HEIGHT = 0x2;
+const uint32_t DDSD_WIDTH = 0x4;
+const uint32_t DDSD_PITCH = 0x8;
+const uint32_t DDSD_PIXELFORMAT = 0x1000;
+const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+
+const uint32_t DDPF_FOURCC = 0x4;
+const uint32_t DDPF_RGB = 0x40;
+const uint32_t DDPF_ALPHAPIXELS = 0x1;
+
+const uint32_t DDSCAPS_COMPLEX = 0x8;
+const uint32_t DDSCAPS_TEXTURE = 0x1000;
+const uint32_t DDSCAPS_MIPMAP = 0x400000;
+const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xfe00;
+const uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+// D3DFMT values used as FourCC codes for float formats.
+const uint32_t D3DFMT_G16R16F = 112;
+const uint32_t D3DFMT_A16B16G16R16F = 113;
+const uint32_t D3DFMT_G32R32F = 115;
+const uint32_t D3DFMT_A32B32G32R32F = 116;
+
+const uint32_t FourCCDx10 = 0x30315844; // "DX10"
+const uint32_t FourCCIblb = 0x424c4249; // "IBLB"
+const uint32_t DXGI_FORMAT_R32G32B32A32_FLOAT = 2;
+const uint32_t DXGI_FORMAT_R16G16B16A16_FLOAT = 10;
+const uint32_t DXGI_FORMAT_R8G8B8A8_UNORM = 28;
+const uint32_t D3D11_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+// Far past any real environment, and small enough that surface sizes cannot wrap.
+const uint64_t MaxTexelCount = uint64_t(1) << 36;
+
+// A full chain, down to 1x1.
+uint32_t
+maxMipCount(uint32_t width, uint32_t height)
+{
+    uint32_t mipCount = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+    {
+        mipCount++;
+    }
+    return mipCount;
+}
+
+DdsFormat
+ddsFormatFromDxgi(uint32_t dxgiFormat)
+{
+    switch (dxgiFormat)
+    {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return DdsRgba32f;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return DdsRgba16f;
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            return DdsRgba8;
+        default:
+            return DdsUnknown;
+    }
+}
+
+DdsFormat
+ddsFormatFromPixelFormat(const DdsPixelFormat& pixelFormat)
+{
+    if (pixelFormat.flags & DDPF_FOURCC)
+    {
+        switch (pixelFormat.fourCC)
+        {
+            case D3DFMT_A16B16G16R16F:
+                return DdsRgba16f;
+            case D3DFMT_A32B32G32R32F:
+                return DdsRgba32f;
+            default:
+                return DdsUnknown;
+        }
+    }
+
+    if ((pixelFormat.flags & DDPF_RGB) &&
+        pixelFormat.rgbBitCount == 32 &&
+        pixelFormat.rBitMask == 0x000000ff &&
+        pixelFormat.gBitMask == 0x0000ff00 &&
+        pixelFormat.bBitMask == 0x00ff0000)
+    {
+        return DdsRgba8;
+    }
+    return DdsUnknown;
+}
+}
+
+DdsDescription::DdsDescription() :
+    width(0),
+    height(0),
+    mipCount(1),
+    faceCount(1),
+    format(DdsUnknown),
+    flags(0)
+{
+}
+
+DdsDescription::DdsDescription(uint32_t inWidth, uint32_t inHeight, uint32_t inMipCount, uint32_t inFaceCount, DdsFormat inFormat,
+                               uint32_t inFlags) :
+    width(inWidth),
+    height(inHeight),
+    mipCount(inMipCount),
+    faceCount(inFaceCount),
+    format(inFormat),
+    flags(inFlags)
+{
+}
+
+uint32_t
+ddsBytesPerTexel(DdsFormat format)
+{
+    switch (format)
+    {
+        case DdsRgba8:
+            return 4;
+        case DdsRgba16f:
+            return 8;
+        case DdsRgba32f:
+            return 16;
+        case DdsRg16:
+        case DdsRg16f:
+            return 4;
+        case DdsRg32f:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+uint32_t
+ddsChannelCount(DdsFormat format)
+{
+    switch (format)
+    {
+        case DdsRg16:
+        case DdsRg16f:
+        case DdsRg32f:
+            return 2;
+        case DdsUnknown:
+            return 0;
+        default:
+            return 4;
+    }
+}
+
+size_t
+ddsSurfaceSize(const DdsDescription& description, uint32_t mip)
+{
+    size_t width = std::max(description.width >> mip, 1u);
+    size_t height = std::max(description.height >> mip, 1u);
+    return width * height * ddsBytesPerTexel(description.format);
+}
+
+size_t
+ddsFaceSize(const DdsDescription& description)
+{
+    size_t size = 0;
+    for (uint32_t mip = 0; mip < description.mipCount; mip++)
+        size += ddsSurfaceSize(description, mip);
+    return size;
+}
+
+DdsDestination::DdsDestination(const std::string& inFilePathName) :
+    filePathName(inFilePathName),
+    bytes(nullptr)
+{
+}
+
+DdsDestination::DdsDestination(const char* inFilePathName) :
+    filePathName(inFilePathName),
+    bytes(nullptr)
+{
+}
+
+DdsDestination::DdsDestination(std::vector<uint8_t>& inBytes) :
+    filePathName("a dds in memory"),
+    bytes(&inBytes)
+{
+}
+
+DdsWriter::DdsWriter() :
+    _file(nullptr),
+    _bytes(nullptr),
+    _remaining(0)
+{
+}
+
+DdsWriter::~DdsWriter()
+{
+    if (_file)
+    {
+        fclose(_file);
+    }
+}
+
+bool
+DdsWriter::open(const DdsDestination& destination, const DdsDescription& description)
+{
+    const std::string& filePathName = destination.filePathName;
+    if (ddsBytesPerTexel(description.format) == 0 ||
+        (description.faceCount != 1 && description.faceCount != 6))
+    {
+        LOG ("Unsupported dds layout for " << filePathName);
+        return false;
+    }
+
+    if (destination.bytes)
+    {
+        _bytes = destination.bytes;
+        _bytes->clear();
+        _bytes->reserve(sizeof(DdsMagic) + sizeof(DdsHeader) + ddsFaceSize(description) * description.faceCount);
+    }
+    else
+    {
+        _file = fopen(filePathName.c_str(), "wb");
+        if (!_file)
+        {
+            LOG ("Failed to open " << filePathName << " for writing");
+            return false;
+        }
+    }
+
+    DdsHeader header;
+    memset(&header, 0, sizeof(header));
+    header.size = sizeof(DdsHeader);
+    header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT;
+    header.width = description.width;
+    header.height = description.height;
+    header.pitchOrLinearSize = description.width * ddsBytesPerTexel(description.format);
+    header.pixelFormat.size = sizeof(DdsPixelFormat);
+    header.caps = DDSCAPS_TEXTURE;
+    uint32_t flags = description.flags & ~DdsFlagMipRoughness;
+    if (!description.mipRoughness.empty() && description.mipRoughness.size() <= DdsMaxMipRoughness)
+    {
+        flags |= DdsFlagMipRoughness;
+        for (uint32_t mip = 0; mip < description.mipRoughness.size(); mip++)
+        {
+            float roughness = std::min(std::max(description.mipRoughness[mip], 0.0f), 1.0f);
+            uint32_t value = uint32_t(roughness * 65535.0f + 0.5f);
+            header.reserved1[2 + mip / 2] |= value << (16 * (mip % 2));
+        }
+    }
+    if (flags)
+    {
+        header.reserved1[0] = FourCCIblb;
+        header.reserved1[1] = flags;
+    }
+
+    if (description.mipCount > 1)
+    {
+        header.flags |= DDSD_MIPMAPCOUNT;
+        header.mipMapCount = description.mipCount;
+        header.caps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+    if (description.faceCount == 6)
+    {
+        header.caps |= DDSCAPS_COMPLEX;
+        header.caps2 = DDSCAPS2_CUBEMAP_ALLFACES;
+    }
+
+    switch (description.format)
+    {
+        case DdsRgba8:
+            header.pixelFormat.flags = DDPF_RGB | DDPF_ALPHAPIXELS;
+            header.pixelFormat.rgbBitCount = 32;
+            header.pixelFormat.rBitMask = 0x000000ff;
+            header.pixelFormat.gBitMask = 0x0000ff00;
+            header.pixelFormat.bBitMask = 0x00ff0000;
+            header.pixelFormat.aBitMask = 0xff000000;
+            break;
+        case DdsRgba16f:
+            header.pixelFormat.flags = DDPF_FOURCC;
+            header.pixelFormat.fourCC = D3DFMT_A16B16G16R16F;
+            break;
+        case DdsRgba32f:
+            header.pixelFormat.flags = DDPF_FOURCC;
+            header.pixelFormat.fourCC = D3DFMT_A32B32G32R32F;
+            break;
+        case DdsRg16:
+            header.pixelFormat.flags = DDPF_RGB;
+            header.pixelFormat.rgbBitCount = 32;
+            header.pixelFormat.rBitMask = 0x0000ffff;
+            header.pixelFormat.gBitMask = 0xffff0000;
+            break;
+        case DdsRg16f:
+            header.pixelFormat.flags = DDPF_FOURCC;
+            header.pixelFormat.fourCC = D3DFMT_G16R16F;
+            break;
+        case DdsRg32f:
+            header.pixelFormat.flags = DDPF_FOURCC;
+            header.pixelFormat.fourCC = D3DFMT_G32R32F;
+            break;
+        default:
+            break;
+    }
+
+    if (!put(&DdsMagic, sizeof(DdsMagic)) || !put(&header, sizeof(header)))
+    {
+        LOG ("Failed to write dds header to " << filePathName);
+        if (_file)
+        {
+            fclose(_file);
+        }
+        _file = nullptr;
+        _bytes = nullptr;
+        return false;
+    }
+
+    _description = description;
+    _remaining = ddsFaceSize(description) * description.faceCount;
+    return true;
+}
+
+bool
+DdsWriter::write(const void* data, size_t size)
+{
+    if ((!_file && !_bytes) || size > _remaining)
+    {
+        return false;
+    }
+
+    if (!put(data, size))
+    {
+        return false;
+    }
+    _remaining -= size;
+    return true;
+}
+
+bool
+DdsWriter::close()
+{
+    if (!_file && !_bytes)
+    {
+        return false;
+    }
+
+    bool complete = _remaining == 0;
+    bool closed = !_file || fclose(_file) == 0;
+    _file = nullptr;
+    _bytes = nullptr;
+
+    if (!complete)
+    {
+        LOG ("Dds closed with " << _remaining << " bytes missing");
+    }
+    return complete && closed;
+}
+
+const DdsDescription&
+DdsWriter::description() const
+{
+    return _description;
+}
+
+bool
+DdsWriter::put(const void* data, size_t size)
+{
+    if (_bytes)
+    {
+        _bytes->insert(_bytes->end(), (const uint8_t*)data, (const uint8_t*)data + size);
+        return true;
+    }
+    return fwrite(data, 1, size, _file) == size;
+}
+
+DdsView::DdsView() :
+    _surfaces(nullptr)
+{
+}
+
+DdsView::~DdsView()
+{
+}
+
+bool
+DdsView::open(const std::string& filePathName)
+{
+    close();
+    if (!_file.open(filePathName))
+    {
+        return false;
+    }
+
+    size_t offset = sizeof(DdsMagic) + sizeof(DdsHeader);
+    const uint8_t* data = _file.data();
+    if (_file.size() < offset || memcmp(data, &DdsMagic, sizeof(DdsMagic)) != 0)
+    {
+        LOG (filePathName << " is not a dds");
+        close();
+        return false;
+    }
+
+    DdsHeader header;
+    memcpy(&header, data + sizeof(DdsMagic), sizeof(header));
+    if (header.size != sizeof(DdsHeader) || (header.caps2 & DDSCAPS2_VOLUME))
+    {
+        close();
+        return false;
+    }
+
+    DdsDescription description(header.width, header.height, 1, 1, DdsUnknown,
+                               header.reserved1[0] == FourCCIblb ? header.reserved1[1] : 0);
+    if ((header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 1)
+    {
+        description.mipCount = header.mipMapCount;
+    }
+    if (description.mipCount > maxMipCount(header.width, header.height) ||
+        uint64_t(header.width) * header.height > MaxTexelCount)
+    {
+        LOG (filePathName << " has " << header.width << "x" << header.height << " texels and " <<
+             description.mipCount << " mips, too many");
+        close();
+        return false;
+    }
+    if ((description.flags & DdsFlagMipRoughness) && description.mipCount <= DdsMaxMipRoughness)
+    {
+        for (uint32_t mip = 0; mip < description.mipCount; mip++)
+        {
+            uint32_t value = (header.reserved1[2 + mip / 2] >> (16 * (mip % 2))) & 0xffff;
+            description.mipRoughness.push_back(value / 65535.0f);
+        }
+    }
+
+    if ((header.pixelFormat.flags & DDPF_FOURCC) && header.pixelFormat.fourCC == FourCCDx10)
+    {
+        DdsHeaderDx10 headerDx10;
+        if (_file.size() < offset + sizeof(headerDx10))
+        {
+            close();
+            return false;
+        }
+        memcpy(&headerDx10, data + offset, sizeof(headerDx10));
+        offset += sizeof(headerDx10);
+
+        if (headerDx10.arraySize > 1)
+        {
+            close();
+            return false;
+        }
+        description.format = ddsFormatFromDxgi(headerDx10.dxgiFormat);
+        description.faceCount = (headerDx10.miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE) ? 6 : 1;
+    }
+    else
+    {
+        description.format = ddsFormatFromPixelFormat(header.pixelFormat);
+        if (header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES)
+        {
+            if ((header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES)
+            {
+                close();
+                return false;
+            }
+            description.faceCount = 6;
+        }
+    }
+
+    if (description.format == DdsUnknown || description.width == 0 || description.height == 0 ||
+        _file.size() < offset + ddsFaceSize(description) * description.faceCount)
+    {
+        close();
+        return false;
+    }
+
+    _description = description;
+    _surfaces = data + offset;
+    return true;
+}
+
+void
+DdsView::close()
+{
+    _file.close();
+    _description = DdsDescription();
+    _surfaces = nullptr;
+}
+
+bool
+DdsView::isOpen() const
+{
+    return _surfaces != nullptr;
+}
+
+const DdsDescription&
+DdsView::description() const
+{
+    return _description;
+}
+
+const uint8_t*
+DdsView::surface(uint32_t face, uint32_t mip) const
+{
+    if (!_surfaces || face >= _description.faceCount || mip >= _description.mipCount)
+    {
+        return nullptr;
+    }
+
+    size_t offset = ddsFaceSize(_description) * face;
+    for (uint32_t level = 0; level < mip; level++)
+    {
+        offset += ddsSurfaceSize(_description, level);
+    }
+    return _surfaces + offset;
+}
+
+const MappedFile&
+DdsView::file() const
+{
+    return _file;
+}
+
+bool
+writeDds(const DdsDestination& destination,
+         const DdsDescription& description,
+         const void* data)
+{
+    DdsWriter writer;
+    return writer.open(destination, description) &&
+           writer.write(data, ddsFaceSize(description) * description.faceCount) &&
+           writer.close();
+}
+}
@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_DDS
+#define INCLUDED_IBL_DDS
+
+#include <IblPlatform.h>
+#include <IblMappedFile.h>
+#include <stdio.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Minimal DDS support for the uncompressed formats the baker reads and writes.      //
+// Faces are stored face major: face 0 mip 0..n, face 1 mip 0..n, ...                 //
+//------------------------------------------------------------------------------------//
+enum DdsFormat
+{
+    DdsUnknown,
+    DdsRgba8,
+    DdsRgba16f,
+    DdsRgba32f,
+    // Two channel formats for the brdf LUT, written but not read.
+    DdsRg16,
+    DdsRg16f,
+    DdsRg32f
+};
+
+#pragma pack(push, 1)
+struct DdsPixelFormat
+{
+    uint32_t                   size;
+    uint32_t                   flags;
+    uint32_t                   fourCC;
+    uint32_t                   rgbBitCount;
+    uint32_t                   rBitMask;
+    uint32_t                   gBitMask;
+    uint32_t                   bBitMask;
+    uint32_t                   aBitMask;
+};
+
+struct DdsHeader
+{
+    uint32_t                   size;
+    uint32_t                   flags;
+    uint32_t                   height;
+    uint32_t                   width;
+    uint32_t                   pitchOrLinearSize;
+    uint32_t                   depth;
+    uint32_t                   mipMapCount;
+    uint32_t                   reserved1[11];
+    DdsPixelFormat             pixelFormat;
+    uint32_t                   caps;
+    uint32_t                   caps2;
+    uint32_t                   caps3;
+    uint32_t                   caps4;
+    uint32_t                   reserved2;
+};
+
+struct DdsHeaderDx10
+{
+    uint32_t                   dxgiFormat;
+    uint32_t                   resourceDimension;
+    uint32_t                   miscFlag;
+    uint32_t                   arraySize;
+    uint32_t                   miscFlags2;
+};
+#pragma pack(pop)
+
+// Bake metadata, kept in reserved1 of the header behind an "IBLB" tag. Other
+// readers ignore it.
+enum DdsFlags
+{
+    // Texel centres are stretched onto the face edges, see SeamFixupWarp.
+    DdsFlagWarpedEdges = 0x1,
+    // reserved1[2..10] hold the roughness each mip was convolved with, 16 bit unorm
+    // values two to a word, low half first. Set from mipRoughness.
+    DdsFlagMipRoughness = 0x2
+};
+
+struct DdsDescription
+{
+    DdsDescription();
+    DdsDescription(uint32_t width, uint32_t height, uint32_t mipCount, uint32_t faceCount, DdsFormat format,
+                   uint32_t flags = 0);
+
+    uint32_t                   width;
+    uint32_t                   height;
+    uint32_t                   mipCount;
+    uint32_t                   faceCount;
+    DdsFormat                  format;
+    uint32_t                   flags;
+    // One value per mip, or empty. Kept for chains of up to DdsMaxMipRoughness mips.
+    std::vector<float>         mipRoughness;
+};
+
+const uint32_t                 DdsMaxMipRoughness = 18;
+
+uint32_t                       ddsBytesPerTexel(DdsFormat format);
+uint32_t                       ddsChannelCount(DdsFormat format);
+size_t                         ddsSurfaceSize(const DdsDescription& description, uint32_t mip);
+size_t                         ddsFaceSize(const DdsDescription& description);
+
+//------------------------------------------------------------------------------------//
+// Streams a DDS to disk. Surfaces must be written in file order, which lets large    //
+// images go out a band at a time instead of being assembled in memory first.         //
+//------------------------------------------------------------------------------------//
+// Where a DdsWriter puts a file: on disk, or into bytes in memory, e.g. for an
+// archive entry.
+struct DdsDestination
+{
+    DdsDestination(const std::string& filePathName);
+    DdsDestination(const char* filePathName);
+    DdsDestination(std::vector<uint8_t>& bytes);
+
+    // For messages when writing to bytes.
+    std::string                filePathName;
+    std::vector<uint8_t>*      bytes;
+};
+
+class DdsWriter
+{
+  public:
+    DdsWriter();
+    ~DdsWriter();
+
+    bool                       open(const DdsDestination& destination, const DdsDescription& description);
+    bool                       write(const void* data, size_t size);
+    bool                       close();
+
+    const DdsDescription&      description() const;
+
+  private:
+    bool                       put(const void* data, size_t size);
+
+    FILE*                      _file;
+    std::vector<uint8_t>*      _bytes;
+    DdsDescription             _description;
+    size_t                     _remaining;
+};
+
+//------------------------------------------------------------------------------------//
+// Maps a dds and exposes its surfaces in place, so large float environments are      //
+// never copied onto the heap. Surface pointers stay valid until the view closes.     //
+//------------------------------------------------------------------------------------//
+class DdsView
+{
+  public:
+    DdsView();
+    ~DdsView();
+
+    // Fails for compressed, volume and partial cube map files.
+    bool                       open(const std::string& filePathName);
+    void                       close();
+
+    bool                       isOpen() const;
+    const DdsDescription&      description() const;
+    const uint8_t*             surface(uint32_t face, uint32_t mip) const;
+
+    const MappedFile&          file() const;
+
+  private:
+    MappedFile                 _file;
+    DdsDescription             _description;
+    const uint8_t*             _surfaces;
+};
+
+bool                           writeDds(const DdsDestination& destination,
+                                        const DdsDescription& description,
+                                        const void* data);
+}
+
+#endif
@@ -0,0 +1,319 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblEnvironmentDecoder.h>
+#include <IblAsyncLoader.h>
+#include <IblDds.h>
+#include <IblFileSystem.h>
+#include <IblRadianceReader.h>
+#include <IblTiledEnvironment.h>
+#include <IblTrace.h>
+#include <FreeImage.h>
+#include <MurmurHash3.h>
+#include <algorithm>
+
+namespace Ctr
+{
+namespace
+{
+const char* EnvironmentCacheDirectory = "data/cache";
+
+// Rows decoded per band on the radiance path, bounds the heap use for huge sources.
+const size_t RadianceBandBytes = 64 << 20;
+
+// Size of the pages touched when warming a mapped dds.
+const size_t PrefetchStride = 4096;
+
+// Swaps a completed decode into place, or throws away the partial file.
+EnvironmentDecodeResult
+finishDecode(const std::string& partialPathName, const std::string& targetPathName, bool written)
+{
+    remove(targetPathName.c_str());
+    if (!written || rename(partialPathName.c_str(), targetPathName.c_str()) != 0)
+    {
+        remove(partialPathName.c_str());
+        return EnvironmentDecodeFailed;
+    }
+    return EnvironmentDecoded;
+}
+
+EnvironmentDecodeResult
+decodeRadiance(const RadianceReader& reader,
+               const std::string& targetPathName,
+               AsyncLoadState& state)
+{
+    uint32_t width = reader.width();
+    uint32_t height = reader.height();
+    size_t rowBytes = size_t(width) * 4 * sizeof(float);
+    uint32_t bandRows = uint32_t(std::max(size_t(1), std::min(size_t(height), RadianceBandBytes / rowBytes)));
+    std::vector<float> band(size_t(bandRows) * width * 4);
+
+    std::string partialPathName = targetPathName + ".part";
+    DdsWriter writer;
+    bool written = writer.open(partialPathName, DdsDescription(width, height, 1, 1, DdsRgba32f));
+    for (uint32_t row = 0; written && row < height; row += bandRows)
+    {
+        if (state.cancelled())
+        {
+            written = false;
+            break;
+        }
+
+        uint32_t rowCount = std::min(bandRows, height - row);
+        {
+            IBL_TRACE_NAMED_SCOPE(bandScope, "Decode band", "load");
+            IBL_TRACE_ARG(bandScope, 0, "rows", rowCount);
+            written = reader.decodeRows(row, rowCount, &band[0]);
+        }
+        {
+            IBL_TRACE_SCOPE("Write band", "load");
+            written = written && writer.write(&band[0], rowBytes * rowCount);
+        }
+        state.setProgress(float(row + rowCount) / float(height));
+    }
+    written = writer.close() && written;
+    return finishDecode(partialPathName, targetPathName, written);
+}
+
+// Dds files go to the texture manager as they are. Faulting the pages in here moves
+// the disk reads off the main thread.
+void
+prefetchDds(const DdsView& view, AsyncLoadState& state)
+{
+    IBL_TRACE_SCOPE("Prefetch dds", "load");
+    const uint8_t* data = view.file().data();
+    size_t size = view.file().size();
+    volatile uint8_t sum = 0;
+    for (size_t offset = 0; offset < size && !state.cancelled(); offset += PrefetchStride)
+    {
+        sum += data[offset];
+        if ((offset & ((PrefetchStride << 8) - 1)) == 0)
+        {
+            state.setProgress(float(offset) / float(size));
+        }
+    }
+}
+
+bool
+exceedsBudget(uint32_t width, uint32_t height, const EnvironmentDecodeSettings& settings)
+{
+    return size_t(width) * size_t(height) * 4 * sizeof(float) > settings.memoryBudget;
+}
+
+EnvironmentDecodeResult
+decodeTiled(EquirectRowSource& source,
+            const std::string& targetPathName,
+            const EnvironmentDecodeSettings& settings,
+            AsyncLoadState& state)
+{
+    LOG ("Streaming " << source.width() << "x" << source.height() << " source into a " <<
+         settings.cubeResolution << " cube");
+    std::string partialPathName = targetPathName + ".part";
+    bool written = writeTiledCubeEnvironment(source, partialPathName, settings.cubeResolution,
+                                             settings.memoryBudget, state);
+    return finishDecode(partialPathName, targetPathName, written);
+}
+}
+
+EnvironmentDecodeSettings::EnvironmentDecodeSettings() :
+    cubeResolution(512),
+    memoryBudget(size_t(1024) << 20)
+{
+}
+
+EnvironmentDecodeResult
+decodeEnvironment(const std::string& sourcePathName,
+                  const std::string& targetPathName,
+                  const EnvironmentDecodeSettings& settings,
+                  AsyncLoadState& state)
+{
+    IBL_TRACE_SCOPE("Decode environment", "load");
+    FREE_IMAGE_FORMAT format = FreeImage_GetFileType(sourcePathName.c_str(), 0);
+    if (format == FIF_UNKNOWN)
+    {
+        format = FreeImage_GetFIFFromFilename(sourcePathName.c_str());
+    }
+    if (format == FIF_DDS)
+    {
+        // Float equirects over the budget are streamed into a cube, everything
+        // else goes to the texture manager as it is.
+        DdsView view;
+        if (view.open(sourcePathName))
+        {
+            const DdsDescription& description = view.description();
+            if (description.faceCount == 1 && description.format != DdsRgba8 &&
+                exceedsBudget(description.width, description.height, settings))
+            {
+                if (fileExists(targetPathName))
+                {
+                    return EnvironmentDecoded;
+                }
+                DdsRowSource rows(view);
+                return decodeTiled(rows, targetPathName, settings, state);
+            }
+            prefetchDds(view, state);
+        }
+        return EnvironmentDecodeNotRequired;
+    }
+    if (format == FIF_UNKNOWN)
+    {
+        return EnvironmentDecodeNotRequired;
+    }
+
+    // Decoded by an earlier session. The name changes with the source's stamp.
+    if (fileExists(targetPathName))
+    {
+        return EnvironmentDecoded;
+    }
+
+    // Radiance files decode straight from the mapped file on all cores.
+    RadianceReader radiance;
+    if (format == FIF_HDR && radiance.open(sourcePathName))
+    {
+        if (exceedsBudget(radiance.width(), radiance.height(), settings))
+        {
+            RadianceRowSource rows(radiance);
+            return decodeTiled(rows, targetPathName, settings, state);
+        }
+        return decodeRadiance(radiance, targetPathName, state);
+    }
+
+    FIBITMAP* bitmap = nullptr;
+    {
+        IBL_TRACE_SCOPE("FreeImage load", "load");
+        bitmap = FreeImage_Load(format, sourcePathName.c_str(), 0);
+    }
+    if (!bitmap)
+    {
+        LOG ("Failed to decode " << sourcePathName);
+        return EnvironmentDecodeFailed;
+    }
+
+    // Ldr images are small and need the 2.2 input gamma the texture format implies.
+    if (FreeImage_GetImageType(bitmap) == FIT_BITMAP)
+    {
+        FreeImage_Unload(bitmap);
+        return EnvironmentDecodeNotRequired;
+    }
+    state.setProgress(0.5f);
+
+    FIBITMAP* rgbaBitmap = nullptr;
+    {
+        IBL_TRACE_SCOPE("Convert to RGBA32F", "load");
+        rgbaBitmap = FreeImage_ConvertToRGBAF(bitmap);
+    }
+    FreeImage_Unload(bitmap);
+    if (!rgbaBitmap)
+    {
+        LOG ("Failed to convert " << sourcePathName << " to RGBA32F");
+        return EnvironmentDecodeFailed;
+    }
+
+    uint32_t width = FreeImage_GetWidth(rgbaBitmap);
+    uint32_t height = FreeImage_GetHeight(rgbaBitmap);
+
+    // Written under a temporary name so an interrupted decode is never picked up later.
+    std::string partialPathName = targetPathName + ".part";
+    DdsWriter writer;
+    bool written = writer.open(partialPathName, DdsDescription(width, height, 1, 1, DdsRgba32f));
+    for (uint32_t y = 0; written && y < height; y++)
+    {
+        if (state.cancelled())
+        {
+            written = false;
+            break;
+        }
+
+        // FreeImage scanlines are bottom up.
+        const BYTE* scanline = FreeImage_GetScanLine(rgbaBitmap, int(height - 1 - y));
+        written = writer.write(scanline, size_t(width) * sizeof(FIRGBAF));
+        state.setProgress(0.5f + 0.5f * float(y + 1) / float(height));
+    }
+    written = writer.close() && written;
+    FreeImage_Unload(rgbaBitmap);
+
+    return finishDecode(partialPathName, targetPathName, written);
+}
+
+std::string
+resolveEnvironment(const std::string& sourcePathName,
+                   const EnvironmentDecodeSettings& settings,
+                   AsyncLoadState& state)
+{
+    std::string cachePathName = environmentCachePathName(sourcePathName, settings);
+    switch (decodeEnvironment(sourcePathName, cachePathName, settings, state))
+    {
+        case EnvironmentDecoded:
+            return cachePathName;
+        case EnvironmentDecodeNotRequired:
+            return sourcePathName;
+        default:
+            return std::string();
+    }
+}
+
+std::string
+environmentCachePathName(const std::string& sourcePathName,
+                         const EnvironmentDecodeSettings& settings)
+{
+    makeDirectory(EnvironmentCacheDirectory);
+
+    // Key on the path, the file stamp and the settings, so an edited source is decoded again.
+    uint32_t hash = 0;
+    std::ostringstream key;
+    key << sourcePathName << fileStamp(sourcePathName) << " " << settings.cubeResolution << " " << settings.memoryBudget;
+    MurmurHash3_x86_32(key.str().c_str(), int(key.str().size()), 0, &hash);
+
+    size_t nameStart = sourcePathName.find_last_of("/\\");
+    nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+    size_t nameEnd = sourcePathName.rfind('.');
+    if (nameEnd == std::string::npos || nameEnd < nameStart)
+    {
+        nameEnd = sourcePathName.size();
+    }
+
+    std::ostringstream pathName;
+    pathName << EnvironmentCacheDirectory << "/"
+             << sourcePathName.substr(nameStart, nameEnd - nameStart)
+             << "." << std::hex << hash << ".dds";
+    return pathName.str();
+}
+}
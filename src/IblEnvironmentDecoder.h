@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_ENVIRONMENT_DECODER
+#define INCLUDED_IBL_ENVIRONMENT_DECODER
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+class AsyncLoadState;
+
+enum EnvironmentDecodeResult
+{
+    EnvironmentDecoded,
+    // Dds and ldr sources go through the texture manager as they are.
+    EnvironmentDecodeNotRequired,
+    EnvironmentDecodeFailed
+};
+
+struct EnvironmentDecodeSettings
+{
+    EnvironmentDecodeSettings();
+
+    // Sources whose RGBA32F decode would be bigger than memoryBudget are streamed
+    // into a cube of cubeResolution instead of being decoded whole.
+    uint32_t                   cubeResolution;
+    size_t                     memoryBudget;
+};
+
+//------------------------------------------------------------------------------------//
+// Decodes a float environment (hdr, exr, pfm, float tiff) into an RGBA32F dds that    //
+// the texture manager can upload without going back through FreeImage. Radiance     //
+// files skip FreeImage and decode from a mapped file. Safe to call from a worker.    //
+//------------------------------------------------------------------------------------//
+EnvironmentDecodeResult        decodeEnvironment(const std::string& sourcePathName,
+                                                 const std::string& targetPathName,
+                                                 const EnvironmentDecodeSettings& settings,
+                                                 AsyncLoadState& state);
+
+// Decodes if needed and returns what the texture manager should load, or an empty
+// string on failure or cancellation.
+std::string                    resolveEnvironment(const std::string& sourcePathName,
+                                                  const EnvironmentDecodeSettings& settings,
+                                                  AsyncLoadState& state);
+
+// Where decoded environments are written. Creates data/cache if needed.
+// The name changes whenever the source file or the settings do.
+std::string                    environmentCachePathName(const std::string& sourcePathName,
+                                                        const EnvironmentDecodeSettings& settings);
+}
+
+#endif
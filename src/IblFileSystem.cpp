@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblFileSystem.h>
+#include <sys/stat.h>
+#include <errno.h>
+#if _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Ctr
+{
+bool
+fileExists(const std::string& filePathName)
+{
+    struct stat fileStat;
+    return stat(filePathName.c_str(), &fileStat) == 0;
+}
+
+uint64_t
+fileStamp(const std::string& filePathName)
+{
+    struct stat fileStat;
+    if (stat(filePathName.c_str(), &fileStat) != 0)
+    {
+        return 0;
+    }
+    return (uint64_t(fileStat.st_mtime) << 24) ^ uint64_t(fileStat.st_size) ^ 1;
+}
+
+bool
+makeDirectory(const std::string& pathName)
+{
+#if _WIN32
+    int result = _mkdir(pathName.c_str());
+#else
+    int result = mkdir(pathName.c_str(), 0755);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+bool
+setWorkingDirectory(const std::string& pathName)
+{
+#if _WIN32
+    return _chdir(pathName.c_str()) == 0;
+#else
+    return chdir(pathName.c_str()) == 0;
+#endif
+}
+}
@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblFrameBudget.h>
+#include <algorithm>
+#include <math.h>
+
+namespace Ctr
+{
+namespace
+{
+// Weight of the newest frame in the smoothed frame time.
+const double FrameSmoothing = 0.25;
+}
+
+FrameBudget::FrameBudget() :
+    _interactiveMilliseconds(1000.0 / 60.0),
+    _idleMilliseconds(100.0),
+    _smoothedMilliseconds(0.0),
+    _minSamples(8),
+    _maxSamples(1024),
+    _samplesPerFrame(8),
+    _interactive(true)
+{
+}
+
+void
+FrameBudget::setTargetMilliseconds(double interactive, double idle)
+{
+    _interactiveMilliseconds = std::max(interactive, 1.0);
+    _idleMilliseconds = std::max(idle, _interactiveMilliseconds);
+}
+
+double
+FrameBudget::targetMilliseconds() const
+{
+    return _interactive ? _interactiveMilliseconds : _idleMilliseconds;
+}
+
+void
+FrameBudget::setSampleRange(uint32_t minSamples, uint32_t maxSamples)
+{
+    _minSamples = std::max(minSamples, 1u);
+    _maxSamples = std::max(maxSamples, _minSamples);
+    _samplesPerFrame = std::min(std::max(_samplesPerFrame, _minSamples), _maxSamples);
+}
+
+uint32_t
+FrameBudget::update(double workMilliseconds, bool interactive)
+{
+    if (interactive != _interactive)
+    {
+        // Frame times from the other mode say nothing about this one.
+        _interactive = interactive;
+        _smoothedMilliseconds = 0.0;
+    }
+
+    if (workMilliseconds <= 0.0)
+    {
+        return _samplesPerFrame;
+    }
+    _smoothedMilliseconds = _smoothedMilliseconds > 0.0 ?
+        _smoothedMilliseconds + (workMilliseconds - _smoothedMilliseconds) * FrameSmoothing :
+        workMilliseconds;
+
+    // Square root damps the step, the smoothed time lags the samples that caused it.
+    double scale = std::min(std::max(sqrt(targetMilliseconds() / _smoothedMilliseconds), 0.5), 2.0);
+    double samples = std::min(std::max(double(_samplesPerFrame) * scale, double(_minSamples)), double(_maxSamples));
+    _samplesPerFrame = uint32_t(samples);
+    return _samplesPerFrame;
+}
+
+uint32_t
+FrameBudget::samplesPerFrame() const
+{
+    return _samplesPerFrame;
+}
+
+bool
+FrameBudget::interactive() const
+{
+    return _interactive;
+}
+}
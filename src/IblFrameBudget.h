@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_FRAME_BUDGET
+#define INCLUDED_IBL_FRAME_BUDGET
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Picks the probe's samples per frame so that an interactive frame stays near a      //
+// target time. The gpu bake runs asynchronously, so the cost of its samples only     //
+// shows up in the time the whole frame's work takes, present included. That is what  //
+// update is given, without any wait for the frame lock. Samples per frame move in    //
+// proportion to how far that time is off the target, at most doubling or halving a   //
+// frame. When nobody is using the window the idle target applies instead, which is   //
+// long enough to bake flat out but short of a gpu timeout.                           //
+//------------------------------------------------------------------------------------//
+class FrameBudget
+{
+  public:
+    FrameBudget();
+
+    void                       setTargetMilliseconds(double interactive, double idle);
+    double                     targetMilliseconds() const;
+    // samplesPerFrame stays within this range, maxSamples is the probe's sample count.
+    void                       setSampleRange(uint32_t minSamples, uint32_t maxSamples);
+
+    // Returns the samples per frame for the next frame.
+    uint32_t                   update(double workMilliseconds, bool interactive);
+
+    uint32_t                   samplesPerFrame() const;
+    bool                       interactive() const;
+
+  private:
+    double                     _interactiveMilliseconds;
+    double                     _idleMilliseconds;
+    double                     _smoothedMilliseconds;
+    uint32_t                   _minSamples;
+    uint32_t                   _maxSamples;
+    uint32_t                   _samplesPerFrame;
+    bool                       _interactive;
+};
+}
+
+#endif
@@ -0,0 +1,396 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblHalf.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define IBL_HALF_SSE2 1
+#include <emmintrin.h>
+#else
+#define IBL_HALF_SSE2 0
+#endif
+
+// F16C needs its own code generation flags on gcc and clang. It is compiled for
+// just the functions that use it, and only called after checking cpuid.
+#if IBL_HALF_SSE2 && defined(_MSC_VER)
+#define IBL_HALF_F16C 1
+#define IBL_HALF_F16C_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#elif IBL_HALF_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define IBL_HALF_F16C 1
+#define IBL_HALF_F16C_TARGET __attribute__((target("avx,f16c")))
+#include <immintrin.h>
+#include <cpuid.h>
+#else
+#define IBL_HALF_F16C 0
+#endif
+
+namespace Ctr
+{
+namespace
+{
+#if IBL_HALF_F16C
+bool
+cpuHasF16c()
+{
+    uint32_t registers[4];
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    memcpy(registers, info, sizeof(registers));
+#else
+    if (!__get_cpuid(1, &registers[0], &registers[1], &registers[2], &registers[3]))
+    {
+        return false;
+    }
+#endif
+
+    // F16C, AVX and OSXSAVE, then the OS has to save the ymm state.
+    const uint32_t required = (1u << 29) | (1u << 28) | (1u << 27);
+    if ((registers[2] & required) != required)
+    {
+        return false;
+    }
+#if defined(_MSC_VER)
+    uint64_t xcr0 = _xgetbv(0);
+#else
+    uint32_t xcr0Low, xcr0High;
+    __asm__ ("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+    uint64_t xcr0 = xcr0Low;
+#endif
+    return (xcr0 & 6) == 6;
+}
+
+IBL_HALF_F16C_TARGET void
+halfToFloatF16c(const uint16_t* source, float* target, size_t count)
+{
+    for (; count >= 8; count -= 8, source += 8, target += 8)
+    {
+        __m128i halfs = _mm_loadu_si128((const __m128i*)source);
+        _mm256_storeu_ps(target, _mm256_cvtph_ps(halfs));
+    }
+    for (size_t index = 0; index < count; index++)
+    {
+        target[index] = halfToFloat(source[index]);
+    }
+}
+
+IBL_HALF_F16C_TARGET void
+floatToHalfF16c(const float* source, uint16_t* target, size_t count)
+{
+    for (; count >= 8; count -= 8, source += 8, target += 8)
+    {
+        __m256 floats = _mm256_loadu_ps(source);
+        _mm_storeu_si128((__m128i*)target, _mm256_cvtps_ph(floats, _MM_FROUND_TO_NEAREST_INT));
+    }
+    for (size_t index = 0; index < count; index++)
+    {
+        target[index] = floatToHalf(source[index]);
+    }
+}
+#endif
+
+#if IBL_HALF_SSE2
+// The exponent is rebiased with a float multiply, which also normalizes denormals.
+void
+halfToFloatSse2(const uint16_t* source, float* target, size_t count)
+{
+    const __m128i expMantissaMask = _mm_set1_epi32(0x7fff);
+    const __m128 rebias = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const __m128i largestFinite = _mm_set1_epi32(0x7bff);
+    const __m128i infinity = _mm_set1_epi32(0x7c00);
+    const __m128i infNanExponent = _mm_set1_epi32(255 << 23);
+    const __m128i quietBit = _mm_set1_epi32(0x400000);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; count >= 4; count -= 4, source += 4, target += 4)
+    {
+        __m128i halfs = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)source), zero);
+        __m128i expMantissa = _mm_and_si128(halfs, expMantissaMask);
+        __m128i sign = _mm_slli_epi32(_mm_xor_si128(halfs, expMantissa), 16);
+
+        __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), rebias);
+        __m128i infNan = _mm_and_si128(_mm_cmpgt_epi32(expMantissa, largestFinite), infNanExponent);
+        __m128i quiet = _mm_and_si128(_mm_cmpgt_epi32(expMantissa, infinity), quietBit);
+
+        __m128i bits = _mm_or_si128(_mm_or_si128(_mm_castps_si128(scaled), infNan), _mm_or_si128(quiet, sign));
+        _mm_storeu_ps(target, _mm_castsi128_ps(bits));
+    }
+    for (size_t index = 0; index < count; index++)
+    {
+        target[index] = halfToFloat(source[index]);
+    }
+}
+
+// Normals round by adding the bias and half an ulp minus the odd bit, denormals
+// by letting a float add round them to the right position.
+void
+floatToHalfSse2(const float* source, uint16_t* target, size_t count)
+{
+    const __m128i signMask = _mm_set1_epi32(int32_t(0x80000000));
+    const __m128i overflow = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i smallestNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i denormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+    const __m128i infinity = _mm_set1_epi32(0x7c00);
+    const __m128i nanBits = _mm_set1_epi32(0x200);
+    const __m128i mantissaMask = _mm_set1_epi32(0x3ff);
+    const __m128i one = _mm_set1_epi32(1);
+
+    for (; count >= 4; count -= 4, source += 4, target += 4)
+    {
+        __m128i bits = _mm_castps_si128(_mm_loadu_ps(source));
+        __m128i sign = _mm_and_si128(bits, signMask);
+        __m128i absolute = _mm_xor_si128(bits, sign);
+
+        __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(_mm_castsi128_ps(absolute), _mm_castsi128_ps(absolute)));
+        __m128i isFinite = _mm_cmpgt_epi32(overflow, absolute);
+        __m128i isDenormal = _mm_cmpgt_epi32(smallestNormal, absolute);
+
+        __m128i nanPayload = _mm_or_si128(nanBits, _mm_and_si128(_mm_srli_epi32(absolute, 13), mantissaMask));
+        __m128i infNan = _mm_or_si128(infinity, _mm_and_si128(isNan, nanPayload));
+
+        __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(absolute),
+                                                                     _mm_castsi128_ps(denormalMagic))),
+                                         denormalMagic);
+
+        __m128i oddBit = _mm_and_si128(_mm_srli_epi32(absolute, 13), one);
+        __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(absolute, normalBias), oddBit), 13);
+
+        __m128i finite = _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+        __m128i halfs = _mm_or_si128(_mm_and_si128(isFinite, finite), _mm_andnot_si128(isFinite, infNan));
+        halfs = _mm_or_si128(halfs, _mm_srli_epi32(sign, 16));
+
+        // packs saturates as signed, so sign extend the halves first.
+        halfs = _mm_srai_epi32(_mm_slli_epi32(halfs, 16), 16);
+        _mm_storel_epi64((__m128i*)target, _mm_packs_epi32(halfs, halfs));
+    }
+    for (size_t index = 0; index < count; index++)
+    {
+        target[index] = floatToHalf(source[index]);
+    }
+}
+#endif
+}
+
+float
+halfToFloat(uint16_t value)
+{
+    uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+    uint32_t bits;
+
+    if (exponent == 0x1f)
+    {
+        bits = sign | 0x7f800000 | (mantissa ? 0x400000 | (mantissa << 13) : 0);
+    }
+    else if (exponent != 0)
+    {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+    else if (mantissa != 0)
+    {
+        // Denormal, renormalize.
+        exponent = 113;
+        while ((mantissa & 0x400) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    else
+    {
+        bits = sign;
+    }
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+uint16_t
+floatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent == 0xff)
+    {
+        return sign | 0x7c00 | (mantissa ? 0x200 | (mantissa >> 13) : 0);
+    }
+
+    int32_t halfExponent = int32_t(exponent) - 112;
+    if (halfExponent >= 0x1f)
+    {
+        return sign | 0x7c00;
+    }
+
+    if (halfExponent <= 0)
+    {
+        // Denormal or zero. Shift the implicit bit in and round to nearest even.
+        if (halfExponent < -10)
+        {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = uint32_t(14 - halfExponent);
+        uint32_t halfMantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (halfMantissa & 1)))
+        {
+            halfMantissa++;
+        }
+        return sign | uint16_t(halfMantissa);
+    }
+
+    uint32_t half = (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fff;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+    {
+        // Carries into the exponent, and to infinity, correctly.
+        half++;
+    }
+    return sign | uint16_t(half);
+}
+
+HalfPath
+bestHalfPath()
+{
+    static const HalfPath path = halfPathSupported(HalfPathF16c) ? HalfPathF16c :
+                                 halfPathSupported(HalfPathSse2) ? HalfPathSse2 : HalfPathScalar;
+    return path;
+}
+
+bool
+halfPathSupported(HalfPath path)
+{
+    switch (path)
+    {
+#if IBL_HALF_F16C
+        case HalfPathF16c:
+        {
+            static const bool supported = cpuHasF16c();
+            return supported;
+        }
+#endif
+        case HalfPathSse2: return IBL_HALF_SSE2 != 0;
+        case HalfPathScalar: return true;
+        default: return false;
+    }
+}
+
+const char*
+halfPathName(HalfPath path)
+{
+    switch (path)
+    {
+        case HalfPathF16c: return "f16c";
+        case HalfPathSse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+void
+halfToFloat(const uint16_t* source, float* target, size_t count)
+{
+    halfToFloat(source, target, count, bestHalfPath());
+}
+
+void
+floatToHalf(const float* source, uint16_t* target, size_t count)
+{
+    floatToHalf(source, target, count, bestHalfPath());
+}
+
+void
+halfToFloat(const uint16_t* source, float* target, size_t count, HalfPath path)
+{
+#if IBL_HALF_F16C
+    if (path == HalfPathF16c && halfPathSupported(HalfPathF16c))
+    {
+        halfToFloatF16c(source, target, count);
+        return;
+    }
+#endif
+#if IBL_HALF_SSE2
+    if (path != HalfPathScalar)
+    {
+        halfToFloatSse2(source, target, count);
+        return;
+    }
+#endif
+    for (size_t index = 0; index < count; index++)
+    {
+        target[index] = halfToFloat(source[index]);
+    }
+}
+
+void
+floatToHalf(const float* source, uint16_t* target, size_t count, HalfPath path)
+{
+#if IBL_HALF_F16C
+    if (path == HalfPathF16c && halfPathSupported(HalfPathF16c))
+    {
+        floatToHalfF16c(source, target, count);
+        return;
+    }
+#endif
+#if IBL_HALF_SSE2
+    if (path != HalfPathScalar)
+    {
+        floatToHalfSse2(source, target, count);
+        return;
+    }
+#endif
+    for (size_t index = 0; index < count; index++)
+    {
+        target[index] = floatToHalf(source[index]);
+    }
+}
+}
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_HALF
+#define INCLUDED_IBL_HALF
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+// IEEE 754 binary16. floatToHalf rounds to nearest even, overflows to infinity
+// and keeps NaNs NaN, quieted, with as much of the payload as fits.
+float                          halfToFloat(uint16_t value);
+uint16_t                       floatToHalf(float value);
+
+// Implementations of the batch conversions. Every path gives the same bits, F16C
+// and SSE2 are only used when the cpu has them.
+enum HalfPath
+{
+    HalfPathScalar,
+    HalfPathSse2,
+    HalfPathF16c
+};
+
+// The fastest path this cpu supports.
+HalfPath                       bestHalfPath();
+bool                           halfPathSupported(HalfPath path);
+const char*                    halfPathName(HalfPath path);
+
+void                           halfToFloat(const uint16_t* source, float* target, size_t count);
+void                           floatToHalf(const float* source, uint16_t* target, size_t count);
+void                           halfToFloat(const uint16_t* source, float* target, size_t count, HalfPath path);
+void                           floatToHalf(const float* source, uint16_t* target, size_t count, HalfPath path);
+}
+
+#endif
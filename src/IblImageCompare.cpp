@@ -0,0 +1,453 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblImageCompare.h>
+#include <IblCubeMap.h>
+#include <IblParallel.h>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+// The cpu only build reads tolerance files when Critter's pugixml is checked out.
+#if !IBL_CPU_ONLY || IBL_HAS_PUGIXML
+#define IBL_TOLERANCE_FILES 1
+#include <pugixml.hpp>
+#else
+#define IBL_TOLERANCE_FILES 0
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define IBL_COMPARE_SSE2 1
+#include <emmintrin.h>
+#else
+#define IBL_COMPARE_SSE2 0
+#endif
+
+namespace Ctr
+{
+namespace
+{
+// Rows per band when a surface is split across threads.
+const uint32_t BandRows = 16;
+
+const float LuminanceWeights[3] = { 0.299f, 0.587f, 0.114f };
+
+// Error sums for a run of texels, merged into a surface total.
+struct ErrorSums
+{
+    ErrorSums() :
+        squared(0), luminanceDifference(0), luminance(0), logSquared(0),
+        maxError(0), logPeak(0), nonFinite(0), count(0)
+    {
+    }
+
+    void                       merge(const ErrorSums& other)
+    {
+        squared += other.squared;
+        luminanceDifference += other.luminanceDifference;
+        luminance += other.luminance;
+        logSquared += other.logSquared;
+        maxError = std::max(maxError, other.maxError);
+        logPeak = std::max(logPeak, other.logPeak);
+        nonFinite += other.nonFinite;
+        count += other.count;
+    }
+
+    ImageError                 error() const
+    {
+        ImageError result;
+        if (count == 0)
+        {
+            return result;
+        }
+
+        double samples = double(count) * 3.0;
+        result.rmse = sqrt(squared / samples);
+        result.relativeLuminanceError = luminance > 0 ? luminanceDifference / luminance : luminanceDifference;
+        result.maxError = maxError;
+        result.nonFiniteCount = nonFinite;
+
+        double logMse = logSquared / samples;
+        double peak = std::max(logPeak, 1.0);
+        result.logPsnr = logMse > 0 ? 10.0 * log10(peak * peak / logMse) : std::numeric_limits<double>::infinity();
+        return result;
+    }
+
+    double                     squared;
+    double                     luminanceDifference;
+    double                     luminance;
+    double                     logSquared;
+    double                     maxError;
+    double                     logPeak;
+    uint64_t                   nonFinite;
+    uint64_t                   count;
+};
+
+// log2 from the exponent bits and the atanh series on the mantissa, good to 2e-5.
+// The scalar and SSE versions give the same results.
+float
+fastLog2(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    float exponent = float(int32_t(bits >> 23) - 127);
+    bits = (bits & 0x007fffff) | 0x3f800000;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    return exponent + t * (2.8853901f + t2 * (0.96179669f + t2 * (0.57707802f + t2 * 0.41219858f)));
+}
+
+void
+accumulateTexel(const float* reference, const float* candidate, ErrorSums& sums)
+{
+    sums.count++;
+    for (uint32_t channel = 0; channel < 3; channel++)
+    {
+        if (!(fabsf(candidate[channel]) <= std::numeric_limits<float>::max()))
+        {
+            sums.nonFinite++;
+            return;
+        }
+    }
+
+    float referenceLuminance = 0;
+    float candidateLuminance = 0;
+    for (uint32_t channel = 0; channel < 3; channel++)
+    {
+        float r = reference[channel];
+        float c = candidate[channel];
+        float difference = c - r;
+        sums.squared += difference * difference;
+        sums.maxError = std::max(sums.maxError, double(fabsf(difference)));
+
+        float logReference = fastLog2(1.0f + std::max(r, 0.0f));
+        float logDifference = fastLog2(1.0f + std::max(c, 0.0f)) - logReference;
+        sums.logSquared += logDifference * logDifference;
+        sums.logPeak = std::max(sums.logPeak, double(logReference));
+
+        referenceLuminance += r * LuminanceWeights[channel];
+        candidateLuminance += c * LuminanceWeights[channel];
+    }
+    sums.luminanceDifference += fabsf(candidateLuminance - referenceLuminance);
+    sums.luminance += fabsf(referenceLuminance);
+}
+
+#if IBL_COMPARE_SSE2
+__m128
+fastLog2(__m128 value)
+{
+    __m128i bits = _mm_castps_si128(value);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+                                             _mm_set1_epi32(0x3f800000)));
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 p = _mm_add_ps(_mm_set1_ps(0.57707802f), _mm_mul_ps(t2, _mm_set1_ps(0.41219858f)));
+    p = _mm_add_ps(_mm_set1_ps(0.96179669f), _mm_mul_ps(t2, p));
+    p = _mm_add_ps(_mm_set1_ps(2.8853901f), _mm_mul_ps(t2, p));
+    return _mm_add_ps(exponent, _mm_mul_ps(t, p));
+}
+
+float
+horizontalSum(__m128 value)
+{
+    __m128 shuffled = _mm_add_ps(value, _mm_movehl_ps(value, value));
+    shuffled = _mm_add_ss(shuffled, _mm_shuffle_ps(shuffled, shuffled, 1));
+    return _mm_cvtss_f32(shuffled);
+}
+
+float
+horizontalMax(__m128 value)
+{
+    __m128 shuffled = _mm_max_ps(value, _mm_movehl_ps(value, value));
+    shuffled = _mm_max_ss(shuffled, _mm_shuffle_ps(shuffled, shuffled, 1));
+    return _mm_cvtss_f32(shuffled);
+}
+#endif
+
+// Four texels at a time, transposed so each register holds one channel of four
+// texels. Float sums are flushed to the doubles once per row.
+void
+accumulateRow(const float* reference, const float* candidate, size_t texelCount, ErrorSums& sums)
+{
+    size_t texel = 0;
+#if IBL_COMPARE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 largest = _mm_set1_ps(std::numeric_limits<float>::max());
+    const __m128 weights[3] = { _mm_set1_ps(LuminanceWeights[0]),
+                                _mm_set1_ps(LuminanceWeights[1]),
+                                _mm_set1_ps(LuminanceWeights[2]) };
+
+    __m128 squared = zero, logSquared = zero, maxError = zero, logPeak = zero;
+    __m128 luminanceDifference = zero, luminance = zero;
+    __m128i nonFinite = _mm_setzero_si128();
+
+    for (; texel + 4 <= texelCount; texel += 4)
+    {
+        __m128 r[4], c[4];
+        for (uint32_t row = 0; row < 4; row++)
+        {
+            r[row] = _mm_loadu_ps(reference + (texel + row) * 4);
+            c[row] = _mm_loadu_ps(candidate + (texel + row) * 4);
+        }
+        _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+        _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+
+        __m128 referenceLuminance = zero, candidateLuminance = zero;
+        __m128 bad = zero;
+        for (uint32_t channel = 0; channel < 3; channel++)
+        {
+            // Not (|c| <= max) catches NaN and infinity. Bad lanes are zeroed so
+            // they do not poison the sums; they are counted instead.
+            __m128 finite = _mm_cmple_ps(_mm_and_ps(c[channel], signMask), largest);
+            bad = _mm_or_ps(bad, _mm_andnot_ps(finite, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+            __m128 candidateValue = _mm_and_ps(c[channel], finite);
+            __m128 referenceValue = _mm_and_ps(r[channel], finite);
+
+            __m128 difference = _mm_sub_ps(candidateValue, referenceValue);
+            squared = _mm_add_ps(squared, _mm_mul_ps(difference, difference));
+            maxError = _mm_max_ps(maxError, _mm_and_ps(difference, signMask));
+
+            __m128 logReference = fastLog2(_mm_add_ps(one, _mm_max_ps(referenceValue, zero)));
+            __m128 logDifference = _mm_sub_ps(fastLog2(_mm_add_ps(one, _mm_max_ps(candidateValue, zero))), logReference);
+            logSquared = _mm_add_ps(logSquared, _mm_mul_ps(logDifference, logDifference));
+            logPeak = _mm_max_ps(logPeak, logReference);
+
+            referenceLuminance = _mm_add_ps(referenceLuminance, _mm_mul_ps(referenceValue, weights[channel]));
+            candidateLuminance = _mm_add_ps(candidateLuminance, _mm_mul_ps(candidateValue, weights[channel]));
+        }
+        nonFinite = _mm_sub_epi32(nonFinite, _mm_castps_si128(bad));
+        luminanceDifference = _mm_add_ps(luminanceDifference,
+                                         _mm_and_ps(_mm_sub_ps(candidateLuminance, referenceLuminance), signMask));
+        luminance = _mm_add_ps(luminance, _mm_and_ps(referenceLuminance, signMask));
+    }
+
+    int32_t nonFiniteLanes[4];
+    _mm_storeu_si128((__m128i*)nonFiniteLanes, nonFinite);
+    sums.nonFinite += nonFiniteLanes[0] + nonFiniteLanes[1] + nonFiniteLanes[2] + nonFiniteLanes[3];
+    sums.squared += horizontalSum(squared);
+    sums.logSquared += horizontalSum(logSquared);
+    sums.luminanceDifference += horizontalSum(luminanceDifference);
+    sums.luminance += horizontalSum(luminance);
+    sums.maxError = std::max(sums.maxError, double(horizontalMax(maxError)));
+    sums.logPeak = std::max(sums.logPeak, double(horizontalMax(logPeak)));
+    sums.count += texel;
+#endif
+
+    for (; texel < texelCount; texel++)
+    {
+        accumulateTexel(reference + texel * 4, candidate + texel * 4, sums);
+    }
+}
+}
+
+ImageError::ImageError() :
+    rmse(0),
+    relativeLuminanceError(0),
+    maxError(0),
+    logPsnr(std::numeric_limits<double>::infinity()),
+    nonFiniteCount(0)
+{
+}
+
+ImageTolerance::ImageTolerance() :
+    maxRmse(0.01),
+    maxRelativeLuminanceError(0.01),
+    maxError(1.0),
+    minLogPsnr(40.0)
+{
+}
+
+bool
+ImageTolerance::accepts(const ImageError& error) const
+{
+    return error.nonFiniteCount == 0 &&
+           error.rmse <= maxRmse &&
+           error.relativeLuminanceError <= maxRelativeLuminanceError &&
+           error.maxError <= maxError &&
+           error.logPsnr >= minLogPsnr;
+}
+
+const ImageTolerance&
+mipTolerance(const MipTolerances& tolerances, uint32_t mip)
+{
+    static const ImageTolerance defaultTolerance;
+    if (tolerances.empty())
+    {
+        return defaultTolerance;
+    }
+    return tolerances[std::min(size_t(mip), tolerances.size() - 1)];
+}
+
+bool
+readMipTolerances(const std::string& filePathName, MipTolerances& tolerances)
+{
+#if !IBL_TOLERANCE_FILES
+    LOG ("Built without pugixml, cannot read " << filePathName);
+    return false;
+#else
+    pugi::xml_document document;
+    if (!document.load_file(filePathName.c_str()))
+    {
+        LOG ("Could not read tolerances from " << filePathName);
+        return false;
+    }
+
+    tolerances.clear();
+    for (pugi::xml_node mipNode : document.child("Tolerances").children("Mip"))
+    {
+        ImageTolerance tolerance;
+        tolerance.maxRmse = mipNode.attribute("Rmse").as_float(float(tolerance.maxRmse));
+        tolerance.maxRelativeLuminanceError = mipNode.attribute("RelativeLuminance").as_float(float(tolerance.maxRelativeLuminanceError));
+        tolerance.maxError = mipNode.attribute("MaxError").as_float(float(tolerance.maxError));
+        tolerance.minLogPsnr = mipNode.attribute("LogPsnr").as_float(float(tolerance.minLogPsnr));
+        tolerances.push_back(tolerance);
+    }
+    return true;
+#endif
+}
+
+ImageError
+compareImages(const float* reference, const float* candidate, size_t texelCount)
+{
+    ErrorSums sums;
+    accumulateRow(reference, candidate, texelCount, sums);
+    return sums.error();
+}
+
+bool
+compareCubeMaps(const CubeMap& reference,
+                const CubeMap& candidate,
+                const MipTolerances& tolerances,
+                std::vector<SurfaceComparison>& comparisons)
+{
+    comparisons.clear();
+    if (reference.size() != candidate.size() || reference.mipCount() != candidate.mipCount())
+    {
+        LOG ("Cube maps differ: " << reference.size() << " with " << reference.mipCount() << " mips against " <<
+             candidate.size() << " with " << candidate.mipCount() << " mips");
+        return false;
+    }
+    if (reference.warpedEdges() != candidate.warpedEdges())
+    {
+        LOG ("Cube maps differ: only one of them was convolved with warped edges");
+        return false;
+    }
+
+    struct Band
+    {
+        uint32_t               surface;
+        uint32_t               firstRow;
+        uint32_t               rowCount;
+    };
+
+    std::vector<Band> bands;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t mip = 0; mip < reference.mipCount(); mip++)
+        {
+            uint32_t size = reference.mipSize(mip);
+            for (uint32_t row = 0; row < size; row += BandRows)
+            {
+                Band band = { face * reference.mipCount() + mip, row, std::min(BandRows, size - row) };
+                bands.push_back(band);
+            }
+        }
+    }
+
+    std::vector<ErrorSums> bandSums(bands.size());
+    parallelFor(uint32_t(bands.size()), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t index = begin; index < end; index++)
+        {
+            const Band& band = bands[index];
+            uint32_t face = band.surface / reference.mipCount();
+            uint32_t mip = band.surface % reference.mipCount();
+            size_t rowTexels = reference.mipSize(mip);
+            size_t offset = band.firstRow * rowTexels * 4;
+
+            const float* referenceTexels = reference.texels(face, mip) + offset;
+            const float* candidateTexels = candidate.texels(face, mip) + offset;
+            for (uint32_t row = 0; row < band.rowCount; row++)
+            {
+                accumulateRow(referenceTexels, candidateTexels, rowTexels, bandSums[index]);
+                referenceTexels += rowTexels * 4;
+                candidateTexels += rowTexels * 4;
+            }
+        }
+    });
+
+    std::vector<ErrorSums> surfaceSums(6 * reference.mipCount());
+    for (size_t index = 0; index < bands.size(); index++)
+    {
+        surfaceSums[bands[index].surface].merge(bandSums[index]);
+    }
+
+    for (uint32_t surface = 0; surface < surfaceSums.size(); surface++)
+    {
+        SurfaceComparison comparison;
+        comparison.face = surface / reference.mipCount();
+        comparison.mip = surface % reference.mipCount();
+        comparison.error = surfaceSums[surface].error();
+        comparison.passed = mipTolerance(tolerances, comparison.mip).accepts(comparison.error);
+        comparisons.push_back(comparison);
+    }
+    return true;
+}
+
+bool
+comparisonsPassed(const std::vector<SurfaceComparison>& comparisons)
+{
+    for (const SurfaceComparison& comparison : comparisons)
+    {
+        if (!comparison.passed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
@@ -0,0 +1,114 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_IMAGE_COMPARE
+#define INCLUDED_IBL_IMAGE_COMPARE
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+class CubeMap;
+
+// Errors are measured on rgb, alpha is ignored.
+struct ImageError
+{
+    ImageError();
+
+    double                     rmse;
+    // Mean absolute luminance difference over mean reference luminance.
+    double                     relativeLuminanceError;
+    double                     maxError;
+    // PSNR of log2(1 + x), so highlights do not swamp everything else. Infinite
+    // for identical images.
+    double                     logPsnr;
+    // NaN or infinite texels in the candidate. Any of these fails a comparison.
+    uint64_t                   nonFiniteCount;
+};
+
+struct ImageTolerance
+{
+    ImageTolerance();
+
+    bool                       accepts(const ImageError& error) const;
+
+    double                     maxRmse;
+    double                     maxRelativeLuminanceError;
+    double                     maxError;
+    double                     minLogPsnr;
+};
+
+// Entry n applies to mip n, mips past the end use the last entry.
+typedef std::vector<ImageTolerance> MipTolerances;
+
+const ImageTolerance&          mipTolerance(const MipTolerances& tolerances, uint32_t mip);
+
+// <Tolerances><Mip Rmse="" RelativeLuminance="" MaxError="" LogPsnr=""/>...</Tolerances>
+// with one Mip element per mip. Missing attributes keep the defaults.
+bool                           readMipTolerances(const std::string& filePathName, MipTolerances& tolerances);
+
+struct SurfaceComparison
+{
+    uint32_t                   face;
+    uint32_t                   mip;
+    ImageError                 error;
+    bool                       passed;
+};
+
+// Both images are RGBA32F.
+ImageError                     compareImages(const float* reference, const float* candidate, size_t texelCount);
+
+//------------------------------------------------------------------------------------//
+// Compares every face and mip of two cubes. Surfaces are cut into bands that run    //
+// in parallel and each band is compared four texels at a time with SSE, so a 512     //
+// chain takes a few milliseconds and can be checked after every bench iteration.     //
+// Returns false if the cubes differ in size or mip count.                            //
+//------------------------------------------------------------------------------------//
+bool                           compareCubeMaps(const CubeMap& reference,
+                                               const CubeMap& candidate,
+                                               const MipTolerances& tolerances,
+                                               std::vector<SurfaceComparison>& comparisons);
+
+// True if every comparison passed.
+bool                           comparisonsPassed(const std::vector<SurfaceComparison>& comparisons);
+}
+
+#endif
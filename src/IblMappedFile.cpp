@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblMappedFile.h>
+#include <algorithm>
+#if _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Ctr
+{
+MappedFile::MappedFile() :
+#if _WIN32
+    _file(INVALID_HANDLE_VALUE),
+    _mapping(nullptr),
+#else
+    _file(-1),
+#endif
+    _data(nullptr),
+    _size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool
+MappedFile::open(const std::string& filePathName)
+{
+    close();
+
+#if _WIN32
+    _file = CreateFileA(filePathName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        close();
+        return false;
+    }
+    _size = size_t(fileSize.QuadPart);
+
+    _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!_mapping)
+    {
+        close();
+        return false;
+    }
+    _data = (const uint8_t*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    _file = ::open(filePathName.c_str(), O_RDONLY);
+    if (_file < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(_file, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close();
+        return false;
+    }
+    _size = size_t(fileStat.st_size);
+
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+    _data = data == MAP_FAILED ? nullptr : (const uint8_t*)data;
+#endif
+
+    if (!_data)
+    {
+        LOG ("Failed to map " << filePathName);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void
+MappedFile::close()
+{
+#if _WIN32
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    if (_file != INVALID_HANDLE_VALUE)
+        CloseHandle(_file);
+    _mapping = nullptr;
+    _file = INVALID_HANDLE_VALUE;
+#else
+    if (_data)
+        munmap((void*)_data, _size);
+    if (_file >= 0)
+        ::close(_file);
+    _file = -1;
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+bool
+MappedFile::isOpen() const
+{
+    return _data != nullptr;
+}
+
+const uint8_t*
+MappedFile::data() const
+{
+    return _data;
+}
+
+size_t
+MappedFile::size() const
+{
+    return _size;
+}
+
+void
+MappedFile::evict(size_t offset, size_t size) const
+{
+    if (!_data || offset >= _size)
+    {
+        return;
+    }
+    size = std::min(size, _size - offset);
+
+#if _WIN32
+    // Unlocking pages that are not locked removes them from the working set.
+    VirtualUnlock((void*)(_data + offset), size);
+#else
+    // madvise wants a page aligned start.
+    size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset & ~(pageSize - 1);
+    madvise((void*)(_data + alignedOffset), size + offset - alignedOffset, MADV_DONTNEED);
+#endif
+}
+}
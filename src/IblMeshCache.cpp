@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblMeshCache.h>
+#include <IblMappedFile.h>
+#include <IblFileSystem.h>
+#include <CtrLog.h>
+#include <MurmurHash3.h>
+#include <Importer.hpp>
+#include <Exporter.hpp>
+#include <postprocess.h>
+#include <scene.h>
+#include <fstream>
+#include <algorithm>
+
+namespace Ctr
+{
+namespace
+{
+// Scene::load applies its own flags to whatever it reads, so only cache steps that are
+// idempotent. Handedness and uv flips have to happen exactly once, in Scene::load.
+const unsigned int CacheImportFlags = aiProcess_Triangulate |
+                                      aiProcess_JoinIdenticalVertices |
+                                      aiProcess_GenSmoothNormals |
+                                      aiProcess_CalcTangentSpace;
+
+// Bump when the flags or the cache layout change.
+const uint32_t CacheVersion = 1;
+
+// MurmurHash3 takes an int length.
+const size_t HashChunkSize = 1 << 30;
+
+std::string
+meshCacheKey(const std::string& assetPathName)
+{
+    MappedFile source;
+    if (!source.open(assetPathName))
+    {
+        return std::string();
+    }
+
+    uint64_t hash[2] = { CacheVersion, 0 };
+    for (size_t offset = 0; offset < source.size(); offset += HashChunkSize)
+    {
+        size_t chunkSize = std::min(HashChunkSize, source.size() - offset);
+        MurmurHash3_x64_128(source.data() + offset, int(chunkSize), uint32_t(hash[0] ^ hash[1]), hash);
+    }
+
+    std::ostringstream key;
+    key << "IBLMeshCache " << CacheVersion << " " << std::hex << hash[0] << hash[1] << " " << CacheImportFlags;
+    return key.str();
+}
+
+std::string
+readCacheKey(const std::string& keyPathName)
+{
+    std::ifstream keyFile(keyPathName.c_str());
+    std::string key;
+    std::getline(keyFile, key);
+    return key;
+}
+}
+
+std::string
+cachedMeshPathName(const std::string& assetPathName)
+{
+    std::string key = meshCacheKey(assetPathName);
+    if (key.empty())
+    {
+        return assetPathName;
+    }
+
+    std::string cachePathName = assetPathName + ".assbin";
+    std::string keyPathName = cachePathName + ".key";
+    if (readCacheKey(keyPathName) == key && fileExists(cachePathName))
+    {
+        return cachePathName;
+    }
+
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(assetPathName.c_str(), CacheImportFlags);
+    if (!scene)
+    {
+        LOG ("Mesh cache could not import " << assetPathName << ": " << importer.GetErrorString());
+        return assetPathName;
+    }
+
+    Assimp::Exporter exporter;
+    if (exporter.Export(scene, "assbin", cachePathName.c_str()) != AI_SUCCESS)
+    {
+        LOG ("Mesh cache could not write " << cachePathName << ": " << exporter.GetErrorString());
+        remove(cachePathName.c_str());
+        return assetPathName;
+    }
+
+    // The key goes last so a partially written cache is never picked up.
+    std::ofstream keyFile(keyPathName.c_str());
+    keyFile << key << std::endl;
+    LOG ("Wrote mesh cache " << cachePathName);
+
+    return cachePathName;
+}
+
+std::string
+cachedMeshMaterialPathName(const std::string& assetPathName,
+                           const std::string& materialPathName)
+{
+    if (!materialPathName.empty())
+    {
+        return materialPathName;
+    }
+
+    size_t extension = assetPathName.rfind('.');
+    std::string sourceMaterialPathName = assetPathName.substr(0, extension) + ".material";
+    return fileExists(sourceMaterialPathName) ? sourceMaterialPathName : materialPathName;
+}
+}
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblParallel.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+
+namespace Ctr
+{
+namespace
+{
+void
+runRange(const std::function<void (uint32_t begin, uint32_t end)>& body, uint32_t begin, uint32_t end)
+{
+    IBL_TRACE_NAMED_SCOPE(rangeScope, "Parallel range", "parallel");
+    IBL_TRACE_ARG(rangeScope, 0, "begin", begin);
+    IBL_TRACE_ARG(rangeScope, 1, "count", end - begin);
+    body(begin, end);
+}
+}
+
+uint32_t
+parallelThreadCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void
+parallelFor(uint32_t count, const std::function<void (uint32_t begin, uint32_t end)>& body)
+{
+    uint32_t threadCount = std::min(parallelThreadCount(), count);
+    if (threadCount <= 1)
+    {
+        if (count > 0)
+        {
+            body(0, count);
+        }
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 1; thread < threadCount; thread++)
+    {
+        uint32_t begin = uint32_t(uint64_t(count) * thread / threadCount);
+        uint32_t end = uint32_t(uint64_t(count) * (thread + 1) / threadCount);
+        threads.push_back(std::thread([&body, thread, begin, end]()
+        {
+            // Worker n of every call shares a lane in the trace.
+            if (Trace::trace()->capturing())
+            {
+                Trace::trace()->setThreadName(("Worker " + std::to_string(thread)).c_str());
+            }
+            runRange(body, begin, end);
+        }));
+    }
+    runRange(body, 0, uint32_t(uint64_t(count) / threadCount));
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+}
@@ -0,0 +1,85 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_PLATFORM
+#define INCLUDED_IBL_PLATFORM
+
+// The cpu only build (IBL_CPU_ONLY) has no Critter, so it gets the few pieces of
+// the platform headers the baker core uses from here. Everything else gets them
+// from Critter as before.
+#if IBL_CPU_ONLY
+#include <stdint.h>
+#include <assert.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <stdexcept>
+#include <sstream>
+
+#define safedelete(x) { delete x; x = nullptr; }
+
+#define LOG(x) { std::ostringstream logStream; logStream << x; Ctr::logMessage(logStream.str()); }
+#define THROW(x) { std::ostringstream throwStream; throwStream << x; throw std::runtime_error(throwStream.str()); }
+
+namespace Ctr
+{
+// Writes a line to stdout. Lines from different threads do not interleave.
+void                           logMessage(const std::string& message);
+}
+#else
+#include <CtrPlatform.h>
+#include <CtrLog.h>
+#endif
+
+namespace Ctr
+{
+// Dispatches pending window messages. Returns true once the application has been
+// asked to quit. Always false where there is no window system.
+bool                           pumpMessages();
+
+// True while one of the application's windows is in the foreground. Always true
+// where there is no window system.
+bool                           applicationHasFocus();
+}
+
+#endif
@@ -0,0 +1,361 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblRadianceReader.h>
+#include <IblParallel.h>
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <stdio.h>
+
+namespace Ctr
+{
+namespace
+{
+// Scanlines of this width use the per channel run length encoding.
+const uint32_t MinEncodedWidth = 8;
+const uint32_t MaxEncodedWidth = 0x7fff;
+
+// Indexing walks the whole file, drop what it has read every so often.
+const size_t IndexEvictBytes = 8 << 20;
+
+bool
+readHeaderLine(const uint8_t* data, size_t size, size_t& offset, std::string& line)
+{
+    const uint8_t* end = (const uint8_t*)memchr(data + offset, '\n', size - offset);
+    if (!end)
+    {
+        return false;
+    }
+    line.assign((const char*)data + offset, (const char*)end);
+    offset = size_t(end - data) + 1;
+    return true;
+}
+
+bool
+isEncodedScanline(const uint8_t* scanline, size_t available, uint32_t width)
+{
+    return width >= MinEncodedWidth && width <= MaxEncodedWidth && available >= 4 &&
+           scanline[0] == 2 && scanline[1] == 2 && (scanline[2] & 0x80) == 0 &&
+           ((uint32_t(scanline[2]) << 8) | scanline[3]) == width;
+}
+
+// Smallest a scanline of this width can be: two byte runs of 127 in every channel
+// when it can be encoded, four bytes a pixel otherwise.
+size_t
+minScanlineBytes(uint32_t width)
+{
+    if (width >= MinEncodedWidth && width <= MaxEncodedWidth)
+    {
+        return 4 + 4 * 2 * size_t((width + 126) / 127);
+    }
+    return size_t(width) * 4;
+}
+
+void
+rgbeToFloat(const uint8_t* rgbe, float* rgba)
+{
+    // Same conversion as FreeImage, so both paths produce identical environments.
+    if (rgbe[3])
+    {
+        float scale = ldexpf(1.0f, int(rgbe[3]) - (128 + 8));
+        rgba[0] = rgbe[0] * scale;
+        rgba[1] = rgbe[1] * scale;
+        rgba[2] = rgbe[2] * scale;
+    }
+    else
+    {
+        rgba[0] = rgba[1] = rgba[2] = 0.0f;
+    }
+    rgba[3] = 1.0f;
+}
+}
+
+RadianceReader::RadianceReader() :
+    _width(0),
+    _height(0),
+    _bottomUp(false)
+{
+}
+
+RadianceReader::~RadianceReader()
+{
+}
+
+bool
+RadianceReader::open(const std::string& filePathName)
+{
+    close();
+    if (!_file.open(filePathName))
+    {
+        return false;
+    }
+
+    const uint8_t* data = _file.data();
+    size_t size = _file.size();
+    if (size < 2 || data[0] != '#' || data[1] != '?')
+    {
+        close();
+        return false;
+    }
+
+    // Header lines run up to an empty line, the resolution line follows.
+    size_t offset = 0;
+    std::string line;
+    bool rgbe = true;
+    while (readHeaderLine(data, size, offset, line) && !line.empty())
+    {
+        if (line.compare(0, 7, "FORMAT=") == 0)
+        {
+            rgbe = line == "FORMAT=32-bit_rle_rgbe";
+        }
+    }
+
+    unsigned int width = 0;
+    unsigned int height = 0;
+    if (!rgbe || !readHeaderLine(data, size, offset, line))
+    {
+        close();
+        return false;
+    }
+    if (sscanf(line.c_str(), "-Y %u +X %u", &height, &width) == 2)
+    {
+        _bottomUp = false;
+    }
+    else if (sscanf(line.c_str(), "+Y %u +X %u", &height, &width) == 2)
+    {
+        _bottomUp = true;
+    }
+    else
+    {
+        close();
+        return false;
+    }
+
+    // The header is not trusted to size anything, every row has to fit in what is
+    // left of the file before the index is allocated.
+    if (width == 0 || height == 0 || height > (size - offset) / minScanlineBytes(width))
+    {
+        close();
+        return false;
+    }
+
+    _width = width;
+    _height = height;
+    if (!indexScanlines(offset))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void
+RadianceReader::close()
+{
+    _file.close();
+    _width = 0;
+    _height = 0;
+    _bottomUp = false;
+    _scanlines.clear();
+}
+
+uint32_t
+RadianceReader::width() const
+{
+    return _width;
+}
+
+uint32_t
+RadianceReader::height() const
+{
+    return _height;
+}
+
+bool
+RadianceReader::indexScanlines(size_t offset)
+{
+    const uint8_t* data = _file.data();
+    size_t size = _file.size();
+
+    size_t evicted = offset;
+    _scanlines.resize(_height);
+    for (uint32_t row = 0; row < _height; row++)
+    {
+        _scanlines[row] = offset;
+        if (offset - evicted >= IndexEvictBytes)
+        {
+            _file.evict(evicted, offset - evicted);
+            evicted = offset;
+        }
+
+        if (isEncodedScanline(data + offset, size - offset, _width))
+        {
+            // Skip the runs without expanding them.
+            offset += 4;
+            for (uint32_t channel = 0; channel < 4; channel++)
+            {
+                for (uint32_t count = 0; count < _width; )
+                {
+                    if (offset >= size)
+                    {
+                        return false;
+                    }
+                    uint32_t code = data[offset++];
+                    uint32_t run = code > 128 ? code - 128 : code;
+                    offset += code > 128 ? 1 : run;
+                    count += run;
+                    if (run == 0 || count > _width || offset > size)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        else
+        {
+            size_t scanlineSize = size_t(_width) * 4;
+            if (size - offset < scanlineSize)
+            {
+                return false;
+            }
+
+            // 1,1,1 pixels are old style repeat markers.
+            for (size_t pixel = offset; pixel < offset + scanlineSize; pixel += 4)
+            {
+                if (data[pixel] == 1 && data[pixel + 1] == 1 && data[pixel + 2] == 1)
+                {
+                    return false;
+                }
+            }
+            offset += scanlineSize;
+        }
+    }
+    return true;
+}
+
+bool
+RadianceReader::decodeScanline(uint32_t row, uint8_t* rgbe, float* rgba) const
+{
+    const uint8_t* data = _file.data() + _scanlines[row];
+
+    if (!isEncodedScanline(data, _file.size() - _scanlines[row], _width))
+    {
+        for (uint32_t x = 0; x < _width; x++)
+        {
+            rgbeToFloat(data + x * 4, rgba + x * 4);
+        }
+        return true;
+    }
+
+    // Channels are encoded one after another, interleave them as they expand.
+    data += 4;
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        uint8_t* target = rgbe + channel;
+        for (uint32_t count = 0; count < _width; )
+        {
+            uint32_t code = *data++;
+            if (code > 128)
+            {
+                uint8_t value = *data++;
+                for (code -= 128; code > 0; code--, count++)
+                {
+                    target[count * 4] = value;
+                }
+            }
+            else
+            {
+                for (; code > 0; code--, count++)
+                {
+                    target[count * 4] = *data++;
+                }
+            }
+        }
+    }
+
+    for (uint32_t x = 0; x < _width; x++)
+    {
+        rgbeToFloat(rgbe + x * 4, rgba + x * 4);
+    }
+    return true;
+}
+
+bool
+RadianceReader::decodeRows(uint32_t firstRow, uint32_t rowCount, float* rgba) const
+{
+    if (_scanlines.empty() || firstRow + rowCount > _height)
+    {
+        return false;
+    }
+
+    std::atomic<bool> decoded(true);
+    parallelFor(rowCount, [&](uint32_t begin, uint32_t end)
+    {
+        std::vector<uint8_t> rgbe(size_t(_width) * 4);
+        for (uint32_t row = begin; row < end && decoded; row++)
+        {
+            uint32_t fileRow = _bottomUp ? _height - 1 - (firstRow + row) : firstRow + row;
+            if (!decodeScanline(fileRow, &rgbe[0], rgba + size_t(row) * _width * 4))
+            {
+                decoded = false;
+            }
+        }
+    });
+    return decoded;
+}
+
+void
+RadianceReader::releaseRows(uint32_t firstRow, uint32_t rowCount) const
+{
+    if (_scanlines.empty() || rowCount == 0 || firstRow + rowCount > _height)
+    {
+        return;
+    }
+
+    // Rows are contiguous in the file, in either direction.
+    uint32_t firstFileRow = _bottomUp ? _height - firstRow - rowCount : firstRow;
+    uint32_t endFileRow = firstFileRow + rowCount;
+    size_t begin = _scanlines[firstFileRow];
+    size_t end = endFileRow < _height ? _scanlines[endFileRow] : _file.size();
+    _file.evict(begin, end - begin);
+}
+}
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_RADIANCE_READER
+#define INCLUDED_IBL_RADIANCE_READER
+
+#include <IblPlatform.h>
+#include <IblMappedFile.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Reads Radiance .hdr files straight out of a mapped file. open() walks the RLE      //
+// stream once to find where each scanline starts. After that, rows can be decoded    //
+// on as many threads as there are cores.                                             //
+//------------------------------------------------------------------------------------//
+class RadianceReader
+{
+  public:
+    RadianceReader();
+    ~RadianceReader();
+
+    // Fails for xyze files, unusual orientations and old style RLE. FreeImage
+    // still handles those.
+    bool                       open(const std::string& filePathName);
+    void                       close();
+
+    uint32_t                   width() const;
+    uint32_t                   height() const;
+
+    // Decodes rows [firstRow, firstRow + rowCount), top row first, into RGBA32F.
+    bool                       decodeRows(uint32_t firstRow, uint32_t rowCount, float* rgba) const;
+
+    // Lets the OS drop the mapped pages behind rows that will not be read again.
+    void                       releaseRows(uint32_t firstRow, uint32_t rowCount) const;
+
+  private:
+    bool                       indexScanlines(size_t offset);
+    bool                       decodeScanline(uint32_t row, uint8_t* rgbe, float* rgba) const;
+
+    MappedFile                 _file;
+    uint32_t                   _width;
+    uint32_t                   _height;
+    bool                       _bottomUp;
+    std::vector<size_t>        _scanlines;
+};
+}
+
+#endif
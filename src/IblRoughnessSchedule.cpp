@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblRoughnessSchedule.h>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
+
+namespace Ctr
+{
+namespace
+{
+// REFLECTION_CAPTURE_ROUGHEST_MIP and REFLECTION_CAPTURE_ROUGHNESS_MIP_SCALE.
+const float UnrealRoughestMip = 1.0f;
+const float UnrealRoughnessMipScale = 1.2f;
+}
+
+const char*
+roughnessCurveName(RoughnessCurve curve)
+{
+    switch (curve)
+    {
+        case RoughnessSqrt: return "sqrt";
+        case RoughnessUnreal: return "unreal";
+        case RoughnessTable: return "table";
+        default: return "linear";
+    }
+}
+
+bool
+parseRoughnessCurve(const std::string& name, RoughnessCurve& curve)
+{
+    const RoughnessCurve curves[] = { RoughnessLinear, RoughnessSqrt, RoughnessUnreal, RoughnessTable };
+    for (RoughnessCurve candidate : curves)
+    {
+        if (name == roughnessCurveName(candidate))
+        {
+            curve = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+RoughnessSchedule::RoughnessSchedule() :
+    curve(RoughnessLinear)
+{
+}
+
+float
+RoughnessSchedule::roughness(uint32_t mip, uint32_t mipCount, uint32_t size) const
+{
+    float t = mipCount > 1 ? float(mip) / float(mipCount - 1) : 0.0f;
+    switch (curve)
+    {
+        case RoughnessSqrt:
+            return t * t;
+        case RoughnessUnreal:
+        {
+            // ComputeReflectionCaptureRoughnessFromMip, counted from the 1x1 mip so a
+            // dropped tail does not shift the curve.
+            float levelFrom1x1 = log2f(float(std::max(size >> mip, 1u)));
+            return std::min(exp2f((UnrealRoughestMip - levelFrom1x1) / UnrealRoughnessMipScale), 1.0f);
+        }
+        case RoughnessTable:
+        {
+            if (table.empty())
+            {
+                return t;
+            }
+            float position = t * float(table.size() - 1);
+            size_t entry = std::min(size_t(position), table.size() - 1);
+            size_t next = std::min(entry + 1, table.size() - 1);
+            float blend = position - float(entry);
+            return table[entry] + (table[next] - table[entry]) * blend;
+        }
+        default:
+            return t;
+    }
+}
+
+bool
+RoughnessSchedule::operator==(const RoughnessSchedule& other) const
+{
+    return curve == other.curve && (curve != RoughnessTable || table == other.table);
+}
+
+bool
+RoughnessSchedule::operator!=(const RoughnessSchedule& other) const
+{
+    return !(*this == other);
+}
+
+bool
+parseRoughnessTable(const std::string& text, std::vector<float>& table)
+{
+    std::vector<float> values;
+    const char* cursor = text.c_str();
+    for (;;)
+    {
+        while (*cursor == ' ' || *cursor == ',' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')
+        {
+            cursor++;
+        }
+        if (!*cursor)
+        {
+            break;
+        }
+
+        char* end = nullptr;
+        float value = strtof(cursor, &end);
+        if (end == cursor || value < 0.0f || value > 1.0f || (!values.empty() && value < values.back()))
+        {
+            LOG ("Bad roughness table entry in " << text);
+            return false;
+        }
+        values.push_back(value);
+        cursor = end;
+    }
+
+    if (values.empty())
+    {
+        LOG ("Empty roughness table");
+        return false;
+    }
+    table.swap(values);
+    return true;
+}
+}
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_ROUGHNESS_SCHEDULE
+#define INCLUDED_IBL_ROUGHNESS_SCHEDULE
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// The roughness each specular mip is convolved with. Engines pick the lod for a      //
+// roughness in different ways, and a chain only looks right with the curve it was    //
+// baked for. With t = mip / (mipCount - 1):                                          //
+//   linear: roughness = t, the probe's own, for lod = roughness * (mips - 1).        //
+//   sqrt:   roughness = t * t, for lod = sqrt(roughness) * (mips - 1).               //
+//   unreal: UE4's reflection captures, 2^((1 - k) / 1.2) for a 2^k wide mip, so the  //
+//           2x2 mip and smaller are fully rough whatever the chain length.           //
+//   table:  roughness read off a table spread evenly from the first mip to the last, //
+//           linearly interpolated. A table with one entry per mip is used as is.     //
+// The baked values go into the dds, see DdsDescription::mipRoughness.                //
+//------------------------------------------------------------------------------------//
+enum RoughnessCurve
+{
+    RoughnessLinear,
+    RoughnessSqrt,
+    RoughnessUnreal,
+    RoughnessTable
+};
+
+const char*                    roughnessCurveName(RoughnessCurve curve);
+bool                           parseRoughnessCurve(const std::string& name, RoughnessCurve& curve);
+
+struct RoughnessSchedule
+{
+    RoughnessSchedule();
+
+    // Roughness of a mip of a chain whose first mip is size wide.
+    float                      roughness(uint32_t mip, uint32_t mipCount, uint32_t size) const;
+
+    bool                       operator==(const RoughnessSchedule& other) const;
+    bool                       operator!=(const RoughnessSchedule& other) const;
+
+    RoughnessCurve             curve;
+    // For RoughnessTable, values in [0, 1] that never decrease.
+    std::vector<float>         table;
+};
+
+// Whitespace or comma separated roughness values, as iblBakerConfig.xml holds them.
+// Fails on values out of [0, 1] or smaller than the one before.
+bool                           parseRoughnessTable(const std::string& text, std::vector<float>& table);
+}
+
+#endif
@@ -0,0 +1,314 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblSeamFixup.h>
+#include <IblCubeMap.h>
+#include <IblParallel.h>
+#include <IblTrace.h>
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define IBL_SEAM_SSE2 1
+#include <emmintrin.h>
+#else
+#define IBL_SEAM_SSE2 0
+#endif
+
+namespace Ctr
+{
+namespace
+{
+// Face edges: texels along x = 0, x = size - 1, y = 0 and y = size - 1.
+enum CubeEdge
+{
+    EdgeLeft,
+    EdgeRight,
+    EdgeTop,
+    EdgeBottom
+};
+
+// The edge of another face that an edge meets, and whether the texels run the
+// other way along it.
+struct EdgeNeighbour
+{
+    uint32_t                   face;
+    uint32_t                   edge;
+    bool                       reversed;
+};
+
+struct CubeTopology
+{
+    EdgeNeighbour              neighbours[6][4];
+};
+
+void
+edgePoint(uint32_t edge, float along, float across, float& u, float& v)
+{
+    switch (edge)
+    {
+        case EdgeLeft: u = -across; v = along; break;
+        case EdgeRight: u = 1.0f + across; v = along; break;
+        case EdgeTop: u = along; v = -across; break;
+        default: u = along; v = 1.0f + across; break;
+    }
+}
+
+// Steps just over each edge and sees where it lands, so the table always agrees
+// with cubeDirection and cubeFaceCoordinates.
+CubeTopology
+buildTopology()
+{
+    CubeTopology topology;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t edge = 0; edge < 4; edge++)
+        {
+            float along[2];
+            EdgeNeighbour& neighbour = topology.neighbours[face][edge];
+            for (uint32_t point = 0; point < 2; point++)
+            {
+                float u, v, direction[3];
+                edgePoint(edge, point ? 0.75f : 0.25f, 0.01f, u, v);
+                cubeDirection(face, u, v, direction);
+
+                float neighbourU, neighbourV;
+                cubeFaceCoordinates(direction, neighbour.face, neighbourU, neighbourV);
+
+                const float distances[4] = { neighbourU, 1.0f - neighbourU, neighbourV, 1.0f - neighbourV };
+                neighbour.edge = 0;
+                for (uint32_t candidate = 1; candidate < 4; candidate++)
+                {
+                    if (distances[candidate] < distances[neighbour.edge])
+                        neighbour.edge = candidate;
+                }
+                along[point] = neighbour.edge <= EdgeRight ? neighbourV : neighbourU;
+            }
+            neighbour.reversed = along[1] < along[0];
+        }
+    }
+    return topology;
+}
+
+const CubeTopology&
+topology()
+{
+    static const CubeTopology cubeTopology = buildTopology();
+    return cubeTopology;
+}
+
+// Texel index within a face of texel i along an edge.
+size_t
+edgeTexel(uint32_t edge, uint32_t index, uint32_t size)
+{
+    switch (edge)
+    {
+        case EdgeLeft: return size_t(index) * size;
+        case EdgeRight: return size_t(index) * size + size - 1;
+        case EdgeTop: return index;
+        default: return size_t(size - 1) * size + index;
+    }
+}
+
+// Up to three texels that end up with their average.
+struct SeamGroup
+{
+    float*                     texels[3];
+    uint32_t                   count;
+};
+
+void
+averageGroup(const SeamGroup& group)
+{
+#if IBL_SEAM_SSE2
+    __m128 sum = _mm_loadu_ps(group.texels[0]);
+    for (uint32_t member = 1; member < group.count; member++)
+        sum = _mm_add_ps(sum, _mm_loadu_ps(group.texels[member]));
+    sum = _mm_mul_ps(sum, _mm_set1_ps(1.0f / group.count));
+    for (uint32_t member = 0; member < group.count; member++)
+        _mm_storeu_ps(group.texels[member], sum);
+#else
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        float sum = 0.0f;
+        for (uint32_t member = 0; member < group.count; member++)
+            sum += group.texels[member][channel];
+        for (uint32_t member = 0; member < group.count; member++)
+            group.texels[member][channel] = sum / group.count;
+    }
+#endif
+}
+
+void
+averageMipSeams(CubeMap& cubeMap, uint32_t mip)
+{
+    uint32_t size = cubeMap.mipSize(mip);
+    float* faces[6];
+    for (uint32_t face = 0; face < 6; face++)
+        faces[face] = cubeMap.texels(face, mip);
+
+    if (size == 1)
+    {
+        // Every face is all corners.
+        for (uint32_t channel = 0; channel < 4; channel++)
+        {
+            float sum = 0.0f;
+            for (uint32_t face = 0; face < 6; face++)
+                sum += faces[face][channel];
+            for (uint32_t face = 0; face < 6; face++)
+                faces[face][channel] = sum / 6.0f;
+        }
+        return;
+    }
+
+    const CubeTopology& cube = topology();
+
+    // Edges, without their corners. Each seam is taken from the lower of its two
+    // (face, edge) sides.
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t edge = 0; edge < 4; edge++)
+        {
+            const EdgeNeighbour& neighbour = cube.neighbours[face][edge];
+            if (neighbour.face * 4 + neighbour.edge < face * 4 + edge)
+            {
+                continue;
+            }
+
+            SeamGroup group;
+            group.count = 2;
+            for (uint32_t index = 1; index + 1 < size; index++)
+            {
+                uint32_t neighbourIndex = neighbour.reversed ? size - 1 - index : index;
+                group.texels[0] = faces[face] + edgeTexel(edge, index, size) * 4;
+                group.texels[1] = faces[neighbour.face] + edgeTexel(neighbour.edge, neighbourIndex, size) * 4;
+                averageGroup(group);
+            }
+        }
+    }
+
+    // Corners, each from the lowest of its three faces. A corner is the start or
+    // end of one vertical and one horizontal edge.
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        for (uint32_t corner = 0; corner < 4; corner++)
+        {
+            uint32_t verticalEdge = (corner & 1) ? EdgeRight : EdgeLeft;
+            uint32_t horizontalEdge = (corner & 2) ? EdgeBottom : EdgeTop;
+            uint32_t verticalIndex = (corner & 2) ? size - 1 : 0;
+            uint32_t horizontalIndex = (corner & 1) ? size - 1 : 0;
+
+            const EdgeNeighbour& first = cube.neighbours[face][verticalEdge];
+            const EdgeNeighbour& second = cube.neighbours[face][horizontalEdge];
+            if (first.face < face || second.face < face)
+            {
+                continue;
+            }
+
+            uint32_t firstIndex = first.reversed ? size - 1 - verticalIndex : verticalIndex;
+            uint32_t secondIndex = second.reversed ? size - 1 - horizontalIndex : horizontalIndex;
+
+            SeamGroup group;
+            group.count = 3;
+            group.texels[0] = faces[face] + edgeTexel(verticalEdge, verticalIndex, size) * 4;
+            group.texels[1] = faces[first.face] + edgeTexel(first.edge, firstIndex, size) * 4;
+            group.texels[2] = faces[second.face] + edgeTexel(second.edge, secondIndex, size) * 4;
+            averageGroup(group);
+        }
+    }
+}
+}
+
+const char*
+seamFixupName(SeamFixup fixup)
+{
+    switch (fixup)
+    {
+        case SeamFixupAverage: return "average";
+        case SeamFixupWarp: return "warp";
+        default: return "none";
+    }
+}
+
+bool
+parseSeamFixup(const std::string& name, SeamFixup& fixup)
+{
+    const SeamFixup fixups[] = { SeamFixupNone, SeamFixupAverage, SeamFixupWarp };
+    for (SeamFixup candidate : fixups)
+    {
+        if (name == seamFixupName(candidate))
+        {
+            fixup = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+float
+cubeTexelCoordinate(uint32_t texel, uint32_t size, bool warp)
+{
+    if (!warp)
+    {
+        return (texel + 0.5f) / size;
+    }
+    return size > 1 ? float(texel) / float(size - 1) : 0.5f;
+}
+
+void
+fixCubeSeams(CubeMap& cubeMap, SeamFixup fixup)
+{
+    if (fixup != SeamFixupAverage)
+    {
+        return;
+    }
+
+    IBL_TRACE_NAMED_SCOPE(seamScope, "Fix seams", "compute");
+    IBL_TRACE_ARG(seamScope, 0, "mips", cubeMap.mipCount());
+    parallelFor(cubeMap.mipCount(), [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t mip = begin; mip < end; mip++)
+        {
+            averageMipSeams(cubeMap, mip);
+        }
+    });
+}
+}
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_SEAM_FIXUP
+#define INCLUDED_IBL_SEAM_FIXUP
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+class CubeMap;
+
+//------------------------------------------------------------------------------------//
+// How a baked chain is kept free of seams once it is filtered without cube seamless  //
+// sampling (older hardware, lower mips on some engines, the MDR outputs).            //
+//   Average: texels either side of a seam are averaged after the convolution, the    //
+//            three texels at a corner likewise.                                      //
+//   Warp:    the convolution stretches texel directions so edge texels sit exactly   //
+//            on the edge, the texels either side of a seam are convolved in the same //
+//            direction and agree without a fixup pass. Readers undo the stretch.     //
+//------------------------------------------------------------------------------------//
+enum SeamFixup
+{
+    SeamFixupNone,
+    SeamFixupAverage,
+    SeamFixupWarp
+};
+
+const char*                    seamFixupName(SeamFixup fixup);
+bool                           parseSeamFixup(const std::string& name, SeamFixup& fixup);
+
+// Face coordinate in [0, 1] of a texel centre. With warp the first and last texel
+// centres are at 0 and 1.
+float                          cubeTexelCoordinate(uint32_t texel, uint32_t size, bool warp);
+
+// Applies an Average fixup to every mip, in parallel. None and Warp leave the
+// texels as they are.
+void                           fixCubeSeams(CubeMap& cubeMap, SeamFixup fixup);
+}
+
+#endif
@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblSourceEnvironment.h>
+#include <IblAsyncLoader.h>
+#include <IblConvolution.h>
+#include <IblCubeMap.h>
+#include <IblDds.h>
+#include <IblHalf.h>
+#include <IblRadianceReader.h>
+#include <IblTiledEnvironment.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <ctype.h>
+
+namespace Ctr
+{
+namespace
+{
+bool
+hasExtension(const std::string& filePathName, const char* extension)
+{
+    size_t length = strlen(extension);
+    if (filePathName.size() < length)
+    {
+        return false;
+    }
+
+    std::string ending = filePathName.substr(filePathName.size() - length);
+    std::transform(ending.begin(), ending.end(), ending.begin(), ::tolower);
+    return ending == extension;
+}
+
+bool
+loadCube(const DdsView& view, const std::string& filePathName, CubeMap& environment)
+{
+    const DdsDescription& description = view.description();
+    if (description.width != description.height)
+    {
+        LOG (filePathName << " has faces that are not square");
+        return false;
+    }
+
+    size_t faceTexels = size_t(description.width) * description.width;
+    environment.create(description.width, cubeMipCount(description.width));
+    environment.setWarpedEdges((description.flags & DdsFlagWarpedEdges) != 0);
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        if (description.format == DdsRgba8)
+        {
+            decodeRgbm(view.surface(face, 0), environment.texels(face, 0), faceTexels);
+        }
+        else if (description.format == DdsRgba16f)
+        {
+            halfToFloat((const uint16_t*)view.surface(face, 0), environment.texels(face, 0), faceTexels * 4);
+        }
+        else
+        {
+            memcpy(environment.texels(face, 0), view.surface(face, 0), faceTexels * 4 * sizeof(float));
+        }
+    }
+    return true;
+}
+}
+
+bool
+loadSourceEnvironment(const std::string& filePathName,
+                      uint32_t cubeResolution,
+                      size_t memoryBudget,
+                      CubeMap& environment,
+                      AsyncLoadState& state)
+{
+    IBL_TRACE_SCOPE("Load source environment", "load");
+    bool loaded = false;
+
+    if (hasExtension(filePathName, ".hdr"))
+    {
+        RadianceReader reader;
+        if (!reader.open(filePathName))
+        {
+            return false;
+        }
+
+        RadianceRowSource rows(reader);
+        environment.create(cubeResolution, cubeMipCount(cubeResolution));
+        loaded = resampleEquirectToCube(rows, environment, memoryBudget, state);
+    }
+    else if (hasExtension(filePathName, ".dds"))
+    {
+        DdsView view;
+        if (!view.open(filePathName))
+        {
+            return false;
+        }
+
+        const DdsDescription& description = view.description();
+        if (description.faceCount == 6)
+        {
+            loaded = loadCube(view, filePathName, environment);
+        }
+        else if (description.format == DdsRgba16f || description.format == DdsRgba32f)
+        {
+            DdsRowSource rows(view);
+            environment.create(cubeResolution, cubeMipCount(cubeResolution));
+            loaded = resampleEquirectToCube(rows, environment, memoryBudget, state);
+        }
+        else
+        {
+            LOG (filePathName << " is neither a cube map nor a float equirect");
+        }
+    }
+    else
+    {
+        LOG ("The cpu baker reads .hdr and .dds environments, not " << filePathName);
+    }
+
+    if (loaded)
+    {
+        IBL_TRACE_SCOPE("Source mips", "load");
+        environment.generateMips();
+    }
+    return loaded;
+}
+}
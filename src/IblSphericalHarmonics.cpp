@@ -0,0 +1,249 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#include <IblSphericalHarmonics.h>
+#include <algorithm>
+#include <math.h>
+
+namespace Ctr
+{
+namespace
+{
+const double Pi = 3.14159265358979323846;
+
+// sqrt((2l + 1) / 4pi * (l - m)! / (l + m)!), times sqrt(2) for m > 0.
+struct ShNormalization
+{
+    ShNormalization()
+    {
+        for (uint32_t l = 0; l < ShBandCount; l++)
+        {
+            for (uint32_t m = 0; m <= l; m++)
+            {
+                double ratio = 1.0;
+                for (uint32_t factor = l - m + 1; factor <= l + m; factor++)
+                {
+                    ratio /= double(factor);
+                }
+                double scale = sqrt((2.0 * l + 1.0) / (4.0 * Pi) * ratio);
+                values[l][m] = float(m > 0 ? sqrt(2.0) * scale : scale);
+            }
+        }
+    }
+
+    float                      values[ShBandCount][ShBandCount];
+};
+
+const ShNormalization normalization;
+
+double
+faceArea(double x, double y)
+{
+    return atan2(x * y, sqrt(x * x + y * y + 1.0));
+}
+}
+
+void
+shBasis(const float* direction, float* basis)
+{
+    float x = direction[0];
+    float y = direction[1];
+    float z = direction[2];
+
+    // sin^m(theta) cos(m phi) and sin^m(theta) sin(m phi) are the parts of (x + iy)^m,
+    // which leaves associated Legendre polynomials without their sin^m(theta) factor.
+    float cosine = 1.0f;
+    float sine = 0.0f;
+    float diagonal = 1.0f;
+    for (uint32_t m = 0; m < ShBandCount; m++)
+    {
+        float previous = 0.0f;
+        float current = diagonal;
+        for (uint32_t l = m; l < ShBandCount; l++)
+        {
+            if (l > m)
+            {
+                float next = l == m + 1 ? z * (2.0f * m + 1.0f) * current :
+                             ((2.0f * l - 1.0f) * z * current - (l + m - 1.0f) * previous) / float(l - m);
+                previous = current;
+                current = next;
+            }
+
+            float scaled = normalization.values[l][m] * current;
+            if (m == 0)
+            {
+                basis[l * (l + 1)] = scaled;
+            }
+            else
+            {
+                basis[l * (l + 1) + m] = scaled * cosine;
+                basis[l * (l + 1) - m] = scaled * sine;
+            }
+        }
+
+        float nextCosine = cosine * x - sine * y;
+        sine = cosine * y + sine * x;
+        cosine = nextCosine;
+        diagonal *= -(2.0f * m + 1.0f);
+    }
+}
+
+ShProjection::ShProjection()
+{
+    memset(coefficients, 0, sizeof(coefficients));
+    energy[0] = energy[1] = energy[2] = 0.0;
+}
+
+void
+ShProjection::add(const float* direction, const float* rgb, float solidAngle)
+{
+    float basis[ShCoefficientCount];
+    shBasis(direction, basis);
+    for (uint32_t coefficient = 0; coefficient < ShCoefficientCount; coefficient++)
+    {
+        float weight = basis[coefficient] * solidAngle;
+        coefficients[coefficient][0] += rgb[0] * weight;
+        coefficients[coefficient][1] += rgb[1] * weight;
+        coefficients[coefficient][2] += rgb[2] * weight;
+    }
+    for (uint32_t channel = 0; channel < 3; channel++)
+    {
+        energy[channel] += double(rgb[channel]) * rgb[channel] * solidAngle;
+    }
+}
+
+float
+cubeTexelSolidAngle(uint32_t x, uint32_t y, uint32_t size)
+{
+    double x0 = 2.0 * x / size - 1.0;
+    double y0 = 2.0 * y / size - 1.0;
+    double x1 = 2.0 * (x + 1) / size - 1.0;
+    double y1 = 2.0 * (y + 1) / size - 1.0;
+    return float(faceArea(x0, y0) - faceArea(x0, y1) - faceArea(x1, y0) + faceArea(x1, y1));
+}
+
+void
+ggxLobeCoefficients(float roughness, uint32_t bandCount, float* coefficients)
+{
+    // The reflection of a half vector at theta / 2 is at theta, and the density of
+    // reflected directions is D / 4 with N = V. Only NoL > 0 contributes.
+    const uint32_t StepCount = 4096;
+    double a = double(roughness) * roughness;
+    double a2 = a * a;
+    std::vector<double> sums(bandCount, 0.0);
+    std::vector<double> legendre(std::max(bandCount, 2u));
+    for (uint32_t step = 0; step < StepCount; step++)
+    {
+        double NoL = (step + 0.5) / StepCount;
+        double NoH2 = 0.5 * (1.0 + NoL);
+        double denominator = NoH2 * (a2 - 1.0) + 1.0;
+        double weight = a2 / (denominator * denominator) * NoL;
+
+        legendre[0] = 1.0;
+        legendre[1] = NoL;
+        for (uint32_t l = 2; l < bandCount; l++)
+        {
+            legendre[l] = ((2.0 * l - 1.0) * NoL * legendre[l - 1] - (l - 1.0) * legendre[l - 2]) / l;
+        }
+        for (uint32_t l = 0; l < bandCount; l++)
+        {
+            sums[l] += weight * legendre[l];
+        }
+    }
+
+    // At roughness 0 the lobe is a delta at NoL = 1, where every Legendre term is 1.
+    for (uint32_t l = 0; l < bandCount; l++)
+    {
+        coefficients[l] = sums[0] > 0.0 ? float(sums[l] / sums[0]) : 1.0f;
+    }
+}
+
+void
+shEvaluate(const ShProjection& projection, const float* lobe, const float* direction, float* rgb)
+{
+    float basis[ShCoefficientCount];
+    shBasis(direction, basis);
+    rgb[0] = rgb[1] = rgb[2] = 0.0f;
+    for (uint32_t l = 0; l < ShBandCount; l++)
+    {
+        for (uint32_t coefficient = l * l; coefficient < (l + 1) * (l + 1); coefficient++)
+        {
+            float weight = lobe[l] * basis[coefficient];
+            rgb[0] += projection.coefficients[coefficient][0] * weight;
+            rgb[1] += projection.coefficients[coefficient][1] * weight;
+            rgb[2] += projection.coefficients[coefficient][2] * weight;
+        }
+    }
+}
+
+float
+shLobeErrorBound(const ShProjection& projection, float roughness)
+{
+    // The lobe's coefficients fall off with band, a few times the bands kept is far
+    // enough out to find the largest one past them.
+    const uint32_t TailBandCount = ShBandCount * 4;
+    float lobe[TailBandCount];
+    ggxLobeCoefficients(roughness, TailBandCount, lobe);
+    float tail = 0.0f;
+    for (uint32_t l = ShBandCount; l < TailBandCount; l++)
+    {
+        tail = std::max(tail, fabsf(lobe[l]));
+    }
+
+    float bound = 0.0f;
+    for (uint32_t channel = 0; channel < 3; channel++)
+    {
+        if (projection.energy[channel] <= 0.0)
+        {
+            continue;
+        }
+        double kept = 0.0;
+        for (uint32_t coefficient = 0; coefficient < ShCoefficientCount; coefficient++)
+        {
+            kept += double(projection.coefficients[coefficient][channel]) * projection.coefficients[coefficient][channel];
+        }
+        double missed = std::max(projection.energy[channel] - kept, 0.0);
+        bound = std::max(bound, float(tail * sqrt(missed / projection.energy[channel])));
+    }
+    return bound;
+}
+}
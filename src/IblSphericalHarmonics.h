@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+
+#ifndef INCLUDED_IBL_SPHERICAL_HARMONICS
+#define INCLUDED_IBL_SPHERICAL_HARMONICS
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+// Real spherical harmonics up to band 8.
+const uint32_t                 ShBandCount = 9;
+const uint32_t                 ShCoefficientCount = ShBandCount * ShBandCount;
+
+// Basis values for a unit direction, coefficient l * (l + 1) + m for band l.
+void                           shBasis(const float* direction, float* basis);
+
+//------------------------------------------------------------------------------------//
+// RGB radiance projected to ShBandCount bands, along with its total energy (the      //
+// integral of its square) so the energy the bands miss is known.                     //
+//------------------------------------------------------------------------------------//
+struct ShProjection
+{
+    ShProjection();
+
+    void                       add(const float* direction, const float* rgb, float solidAngle);
+
+    float                      coefficients[ShCoefficientCount][3];
+    double                     energy[3];
+};
+
+// Solid angle of texel (x, y) of a size * size cube face.
+float                          cubeTexelSolidAngle(uint32_t x, uint32_t y, uint32_t size);
+
+// Zonal coefficients of the lobe the specular convolution applies at a roughness:
+// GGX distributed reflection directions around N = V, weighted by NoL and normalized
+// so band 0 is 1. Numerically integrated, meant for the wide lobes of the rough mips.
+void                           ggxLobeCoefficients(float roughness, uint32_t bandCount, float* coefficients);
+
+// The projection convolved with a zonal lobe, evaluated in a direction.
+void                           shEvaluate(const ShProjection& projection,
+                                          const float* lobe,
+                                          const float* direction,
+                                          float* rgb);
+
+// Bound on the RMS error over the sphere of convolving with the first ShBandCount
+// bands of the lobe instead of all of them, relative to the RMS of the radiance and
+// the largest of the three channels. The error is the lobe's largest coefficient
+// past the last band times the energy the projection misses, so it holds for any
+// environment.
+float                          shLobeErrorBound(const ShProjection& projection, float roughness);
+}
+
+#endif
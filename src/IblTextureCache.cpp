@@ -0,0 +1,242 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblTextureCache.h>
+#include <IblFileSystem.h>
+#include <CtrTextureMgr.h>
+#include <CtrLog.h>
+
+namespace Ctr
+{
+namespace
+{
+size_t
+texelBytes(PixelFormat format)
+{
+    switch (format)
+    {
+        case PF_FLOAT32_RGBA:
+            return 16;
+        case PF_FLOAT32_RGB:
+            return 12;
+        case PF_FLOAT16_RGBA:
+        case PF_FLOAT32_GR:
+            return 8;
+        case PF_FLOAT16_GR:
+        case PF_FLOAT32_R:
+            return 4;
+        case PF_FLOAT16_R:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+size_t
+estimateTextureBytes(const ITexture* texture)
+{
+    size_t bytes = size_t(texture->width()) * size_t(texture->height()) * texelBytes(texture->format());
+    if (texture->isCubeMap())
+    {
+        bytes *= 6;
+    }
+    // Assume a full mip chain.
+    return bytes + bytes / 3;
+}
+}
+
+TextureCache::TextureCache(TextureMgr* textureMgr, size_t budgetBytes) :
+    _textureMgr(textureMgr),
+    _budgetBytes(budgetBytes),
+    _residentBytes(0),
+    _useCount(0)
+{
+}
+
+TextureCache::~TextureCache()
+{
+    // The texture manager owns the textures and frees whatever is left.
+}
+
+const ITexture*
+TextureCache::acquire(const std::string& filePathName)
+{
+    uint64_t stamp = fileStamp(filePathName);
+
+    auto pathIt = _pathIndex.find(filePathName);
+    if (pathIt != _pathIndex.end())
+    {
+        Entry& entry = _entries[pathIt->second];
+        if (entry.stamp == stamp || entry.references > 0)
+        {
+            if (entry.stamp != stamp)
+            {
+                LOG (filePathName << " changed on disk but is still in use, not reloading");
+            }
+            entry.references++;
+            entry.lastUsed = ++_useCount;
+            return pathIt->second;
+        }
+        evict(pathIt->second);
+    }
+
+    const ITexture* texture = _textureMgr->loadTexture(filePathName);
+    if (!texture)
+    {
+        return nullptr;
+    }
+
+    // The texture may already be here as an adopted material default.
+    auto entryIt = _entries.find(texture);
+    if (entryIt == _entries.end())
+    {
+        Entry entry;
+        entry.references = 0;
+        entry.bytes = estimateTextureBytes(texture);
+        entryIt = _entries.insert(std::make_pair(texture, entry)).first;
+        _residentBytes += entry.bytes;
+    }
+
+    entryIt->second.pathName = filePathName;
+    entryIt->second.stamp = stamp;
+    entryIt->second.references++;
+    entryIt->second.lastUsed = ++_useCount;
+    _pathIndex[filePathName] = texture;
+
+    trim();
+    return texture;
+}
+
+void
+TextureCache::release(const ITexture* texture)
+{
+    if (!texture)
+    {
+        return;
+    }
+
+    auto entryIt = _entries.find(texture);
+    if (entryIt == _entries.end())
+    {
+        Entry entry;
+        entry.stamp = 0;
+        entry.references = 0;
+        entry.bytes = estimateTextureBytes(texture);
+        entryIt = _entries.insert(std::make_pair(texture, entry)).first;
+        _residentBytes += entry.bytes;
+    }
+    else if (entryIt->second.references > 0)
+    {
+        entryIt->second.references--;
+    }
+
+    entryIt->second.lastUsed = ++_useCount;
+    trim();
+}
+
+bool
+TextureCache::contains(const std::string& filePathName) const
+{
+    auto pathIt = _pathIndex.find(filePathName);
+    if (pathIt == _pathIndex.end())
+    {
+        return false;
+    }
+    return _entries.find(pathIt->second)->second.stamp == fileStamp(filePathName);
+}
+
+void
+TextureCache::setBudget(size_t budgetBytes)
+{
+    _budgetBytes = budgetBytes;
+    trim();
+}
+
+size_t
+TextureCache::budget() const
+{
+    return _budgetBytes;
+}
+
+size_t
+TextureCache::residentBytes() const
+{
+    return _residentBytes;
+}
+
+void
+TextureCache::trim()
+{
+    while (_residentBytes > _budgetBytes)
+    {
+        auto oldestIt = _entries.end();
+        for (auto entryIt = _entries.begin(); entryIt != _entries.end(); entryIt++)
+        {
+            if (entryIt->second.references == 0 &&
+                (oldestIt == _entries.end() || entryIt->second.lastUsed < oldestIt->second.lastUsed))
+            {
+                oldestIt = entryIt;
+            }
+        }
+
+        // Everything left is in use.
+        if (oldestIt == _entries.end())
+        {
+            break;
+        }
+        evict(oldestIt->first);
+    }
+}
+
+void
+TextureCache::evict(const ITexture* texture)
+{
+    auto entryIt = _entries.find(texture);
+    if (!entryIt->second.pathName.empty())
+    {
+        _pathIndex.erase(entryIt->second.pathName);
+    }
+    _residentBytes -= entryIt->second.bytes;
+    _entries.erase(entryIt);
+
+    _textureMgr->recycle(const_cast<ITexture*>(texture));
+}
+}
@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_TEXTURE_CACHE
+#define INCLUDED_IBL_TEXTURE_CACHE
+
+#include <CtrPlatform.h>
+
+namespace Ctr
+{
+class ITexture;
+class TextureMgr;
+
+//------------------------------------------------------------------------------------//
+// Reference counted front end to the texture manager for environments. Textures     //
+// nobody references stay resident so switching back to them is free, until the      //
+// cache goes over its budget. Then the least recently used are recycled.             //
+// Entries are keyed on path and file stamp, so an edited file is reloaded.           //
+//------------------------------------------------------------------------------------//
+class TextureCache
+{
+  public:
+    TextureCache(TextureMgr* textureMgr, size_t budgetBytes);
+    ~TextureCache();
+
+    const ITexture*            acquire(const std::string& filePathName);
+
+    // Textures the cache did not load (material defaults) are adopted here,
+    // which makes them evictable too.
+    void                       release(const ITexture* texture);
+
+    // True if the file is resident and up to date.
+    bool                       contains(const std::string& filePathName) const;
+
+    void                       setBudget(size_t budgetBytes);
+    size_t                     budget() const;
+    size_t                     residentBytes() const;
+
+  private:
+    struct Entry
+    {
+        std::string            pathName;
+        uint64_t               stamp;
+        uint32_t               references;
+        size_t                 bytes;
+        uint64_t               lastUsed;
+    };
+
+    void                       trim();
+    void                       evict(const ITexture* texture);
+
+    TextureMgr*                _textureMgr;
+    size_t                     _budgetBytes;
+    size_t                     _residentBytes;
+    uint64_t                   _useCount;
+
+    std::map<const ITexture*, Entry> _entries;
+    std::map<std::string, const ITexture*> _pathIndex;
+};
+}
+
+#endif
@@ -0,0 +1,590 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblTiledEnvironment.h>
+#include <IblAsyncLoader.h>
+#include <IblCubeMap.h>
+#include <IblDds.h>
+#include <IblHalf.h>
+#include <IblParallel.h>
+#include <IblRadianceReader.h>
+#include <IblTrace.h>
+#include <algorithm>
+#include <math.h>
+
+namespace Ctr
+{
+namespace
+{
+const float Pi = 3.14159265358979f;
+
+// Face order and orientation match D3D cube maps.
+void
+cubeTexel(float x, float y, float z, uint32_t resolution, uint32_t& face, uint32_t& s, uint32_t& t)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float az = fabsf(z);
+    float sc, tc, ma;
+
+    if (ax >= ay && ax >= az)
+    {
+        ma = ax;
+        face = x > 0 ? 0 : 1;
+        sc = x > 0 ? -z : z;
+        tc = -y;
+    }
+    else if (ay >= az)
+    {
+        ma = ay;
+        face = y > 0 ? 2 : 3;
+        sc = x;
+        tc = y > 0 ? z : -z;
+    }
+    else
+    {
+        ma = az;
+        face = z > 0 ? 4 : 5;
+        sc = z > 0 ? x : -x;
+        tc = -y;
+    }
+
+    float u = 0.5f * (sc / ma + 1.0f);
+    float v = 0.5f * (tc / ma + 1.0f);
+    s = std::min(uint32_t(std::max(u, 0.0f) * resolution), resolution - 1);
+    t = std::min(uint32_t(std::max(v, 0.0f) * resolution), resolution - 1);
+}
+
+// Centre of a cube texel, not normalized. The inverse of cubeTexel.
+void
+texelDirection(uint32_t face, uint32_t s, uint32_t t, uint32_t resolution, float& x, float& y, float& z)
+{
+    float u = 2.0f * (s + 0.5f) / resolution - 1.0f;
+    float v = 2.0f * (t + 0.5f) / resolution - 1.0f;
+    switch (face)
+    {
+        case 0: x = 1.0f;  y = -v;    z = -u;   break;
+        case 1: x = -1.0f; y = -v;    z = u;    break;
+        case 2: x = u;     y = 1.0f;  z = v;    break;
+        case 3: x = u;     y = -1.0f; z = -v;   break;
+        case 4: x = u;     y = -v;    z = 1.0f; break;
+        default: x = -u;   y = -v;    z = -1.0f; break;
+    }
+}
+
+// Where a cube texel centre lands in the source, in texels. Column 0 starts at phi 2 pi.
+void
+equirectPosition(uint32_t face, uint32_t s, uint32_t t, uint32_t resolution,
+                 uint32_t width, uint32_t height, float& column, float& row)
+{
+    float x, y, z;
+    texelDirection(face, s, t, resolution, x, y, z);
+    float theta = acosf(std::max(-1.0f, std::min(1.0f, y / sqrtf(x * x + y * y + z * z))));
+    float phi = atan2f(z, x);
+    column = width * (1.0f - phi / (2.0f * Pi)) - 0.5f;
+    row = height * theta / Pi - 0.5f;
+}
+
+// A texel less than this many source texel spacings across, along its shorter side,
+// may have no source texel land in it, so it samples the source instead.
+const float SplatMinSpacings = 2.0f;
+
+// Fewer sampled texels than this in a band are not worth the threads.
+const uint32_t SampleParallelTexels = 16384;
+
+// The bottom one of the two source rows a texel interpolates.
+uint32_t
+bottomRow(float row, uint32_t height)
+{
+    return std::min(uint32_t(std::max(row + 1.0f, 0.0f)), height - 1);
+}
+
+// Texels that sample the source, bucketed by their bottom row so each is sampled
+// once that row has been read.
+struct SampledTexels
+{
+    std::vector<uint32_t>      rowStart;
+    std::vector<uint32_t>      texels;
+};
+
+void
+findSampledTexels(uint32_t resolution, uint32_t width, uint32_t height, SampledTexels& sampled)
+{
+    sampled.rowStart.assign(height + 1, 0);
+    sampled.texels.clear();
+
+    // A cube texel is 2 / resolution across at the face centre and shrinks by
+    // 1 + u^2 + v^2 towards the corners. Source texels are at least pi / height apart.
+    float largestSpacing = std::max(Pi / height, 2.0f * Pi / width);
+    if (2.0f / (3.0f * resolution) >= SplatMinSpacings * largestSpacing)
+    {
+        return;
+    }
+
+    const uint32_t Splatted = ~0u;
+    std::vector<uint32_t> rows(size_t(resolution) * resolution * 6);
+    parallelFor(resolution * 6, [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t faceRow = begin; faceRow < end; faceRow++)
+        {
+            uint32_t face = faceRow / resolution;
+            uint32_t t = faceRow % resolution;
+            for (uint32_t s = 0; s < resolution; s++)
+            {
+                float x, y, z;
+                texelDirection(face, s, t, resolution, x, y, z);
+                float length = sqrtf(x * x + y * y + z * z);
+                float sinTheta = sqrtf(x * x + z * z) / length;
+                float row = height * acosf(std::max(-1.0f, std::min(1.0f, y / length))) / Pi - 0.5f;
+
+                float texelSize = 2.0f / (resolution * length * length);
+                float spacing = std::max(Pi / height, 2.0f * Pi * sinTheta / width);
+                rows[size_t(faceRow) * resolution + s] = texelSize < SplatMinSpacings * spacing ?
+                                                         bottomRow(row, height) : Splatted;
+            }
+        }
+    });
+
+    for (uint32_t row : rows)
+    {
+        if (row != Splatted)
+        {
+            sampled.rowStart[row + 1]++;
+        }
+    }
+    for (uint32_t row = 0; row < height; row++)
+    {
+        sampled.rowStart[row + 1] += sampled.rowStart[row];
+    }
+
+    std::vector<uint32_t> next(sampled.rowStart.begin(), sampled.rowStart.end() - 1);
+    sampled.texels.resize(sampled.rowStart[height]);
+    for (size_t texelId = 0; texelId < rows.size(); texelId++)
+    {
+        if (rows[texelId] != Splatted)
+        {
+            sampled.texels[next[rows[texelId]]++] = uint32_t(texelId);
+        }
+    }
+}
+
+// Texels no source texel landed in and that do not sample the source take the
+// average of their covered neighbours, growing inwards until none are left. With
+// SplatMinSpacings every texel should be covered, this only guards the margin.
+void
+fillHoles(float* face, uint32_t resolution)
+{
+    std::vector<uint8_t> covered(size_t(resolution) * resolution);
+    bool holes = false;
+    for (size_t texel = 0; texel < covered.size(); texel++)
+    {
+        covered[texel] = face[texel * 4 + 3] != 0.0f;
+        holes |= !covered[texel];
+    }
+
+    std::vector<size_t> filled;
+    while (holes)
+    {
+        filled.clear();
+        holes = false;
+        for (uint32_t t = 0; t < resolution; t++)
+        {
+            for (uint32_t s = 0; s < resolution; s++)
+            {
+                size_t texel = size_t(t) * resolution + s;
+                if (covered[texel])
+                {
+                    continue;
+                }
+
+                float sum[3] = { 0, 0, 0 };
+                uint32_t count = 0;
+                const int offsets[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+                for (const auto& offset : offsets)
+                {
+                    int ns = int(s) + offset[0];
+                    int nt = int(t) + offset[1];
+                    if (ns < 0 || nt < 0 || ns >= int(resolution) || nt >= int(resolution))
+                    {
+                        continue;
+                    }
+                    size_t neighbour = size_t(nt) * resolution + ns;
+                    if (covered[neighbour])
+                    {
+                        for (uint32_t channel = 0; channel < 3; channel++)
+                            sum[channel] += face[neighbour * 4 + channel];
+                        count++;
+                    }
+                }
+
+                if (count)
+                {
+                    for (uint32_t channel = 0; channel < 3; channel++)
+                        face[texel * 4 + channel] = sum[channel] / count;
+                    filled.push_back(texel);
+                }
+                else
+                {
+                    holes = true;
+                }
+            }
+        }
+
+        if (filled.empty())
+        {
+            break;
+        }
+        for (size_t texel : filled)
+        {
+            covered[texel] = 1;
+        }
+    }
+}
+}
+
+RadianceRowSource::RadianceRowSource(const RadianceReader& reader) :
+    _reader(reader)
+{
+}
+
+uint32_t
+RadianceRowSource::width() const
+{
+    return _reader.width();
+}
+
+uint32_t
+RadianceRowSource::height() const
+{
+    return _reader.height();
+}
+
+bool
+RadianceRowSource::readRows(uint32_t firstRow, uint32_t rowCount, float* rgba)
+{
+    return _reader.decodeRows(firstRow, rowCount, rgba);
+}
+
+void
+RadianceRowSource::releaseRows(uint32_t firstRow, uint32_t rowCount)
+{
+    _reader.releaseRows(firstRow, rowCount);
+}
+
+size_t
+RadianceRowSource::mappedRowBytes() const
+{
+    // Flat RGBE, run length encoded rows are no bigger.
+    return size_t(_reader.width()) * 4;
+}
+
+DdsRowSource::DdsRowSource(const DdsView& view) :
+    _view(view)
+{
+}
+
+uint32_t
+DdsRowSource::width() const
+{
+    return _view.description().width;
+}
+
+uint32_t
+DdsRowSource::height() const
+{
+    return _view.description().height;
+}
+
+bool
+DdsRowSource::readRows(uint32_t firstRow, uint32_t rowCount, float* rgba)
+{
+    size_t texelCount = size_t(rowCount) * width() * 4;
+    if (_view.description().format == DdsRgba32f)
+    {
+        memcpy(rgba, rows(firstRow), texelCount * sizeof(float));
+        return true;
+    }
+
+    halfToFloat((const uint16_t*)rows(firstRow), rgba, texelCount);
+    return true;
+}
+
+void
+DdsRowSource::releaseRows(uint32_t firstRow, uint32_t rowCount)
+{
+    _view.file().evict(size_t(rows(firstRow) - _view.file().data()), mappedRowBytes() * rowCount);
+}
+
+size_t
+DdsRowSource::mappedRowBytes() const
+{
+    return size_t(width()) * ddsBytesPerTexel(_view.description().format);
+}
+
+const uint8_t*
+DdsRowSource::rows(uint32_t firstRow) const
+{
+    return _view.surface(0, 0) + size_t(firstRow) * width() * ddsBytesPerTexel(_view.description().format);
+}
+
+MemoryRowSource::MemoryRowSource(const float* rgba, uint32_t width, uint32_t height) :
+    _rgba(rgba),
+    _width(width),
+    _height(height)
+{
+}
+
+uint32_t
+MemoryRowSource::width() const
+{
+    return _width;
+}
+
+uint32_t
+MemoryRowSource::height() const
+{
+    return _height;
+}
+
+bool
+MemoryRowSource::readRows(uint32_t firstRow, uint32_t rowCount, float* rgba)
+{
+    memcpy(rgba, _rgba + size_t(firstRow) * _width * 4, size_t(rowCount) * _width * 4 * sizeof(float));
+    return true;
+}
+
+bool
+writeTiledCubeEnvironment(EquirectRowSource& source,
+                          const std::string& targetPathName,
+                          uint32_t cubeResolution,
+                          size_t memoryBudget,
+                          AsyncLoadState& state)
+{
+    if (cubeResolution == 0)
+    {
+        return false;
+    }
+
+    CubeMap cubeMap(cubeResolution, 1);
+    if (!resampleEquirectToCube(source, cubeMap, memoryBudget, state))
+    {
+        return false;
+    }
+
+    IBL_TRACE_SCOPE("Write cube", "load");
+    return cubeMap.save(targetPathName);
+}
+
+bool
+resampleEquirectToCube(EquirectRowSource& source,
+                       CubeMap& cubeMap,
+                       size_t memoryBudget,
+                       AsyncLoadState& state)
+{
+    uint32_t width = source.width();
+    uint32_t height = source.height();
+    uint32_t cubeResolution = cubeMap.size();
+    if (width == 0 || height == 0 || cubeResolution == 0)
+    {
+        return false;
+    }
+
+    // Weighted rgb sums per cube texel, the weight goes in alpha. Texels that sample
+    // the source are marked with an alpha of -1 and take no splats.
+    size_t faceTexels = size_t(cubeResolution) * cubeResolution;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        std::fill(cubeMap.texels(face, 0), cubeMap.texels(face, 0) + faceTexels * 4, 0.0f);
+    }
+
+    SampledTexels sampled;
+    {
+        IBL_TRACE_SCOPE("Find sampled texels", "load");
+        findSampledTexels(cubeResolution, width, height, sampled);
+    }
+    for (uint32_t texelId : sampled.texels)
+    {
+        cubeMap.texels(texelId / uint32_t(faceTexels), 0)[(texelId % faceTexels) * 4 + 3] = -1.0f;
+    }
+    bool splats = sampled.texels.size() < faceTexels * 6;
+
+    std::vector<float> cosPhi(width);
+    std::vector<float> sinPhi(width);
+    for (uint32_t x = 0; x < width; x++)
+    {
+        // Inverse of texSpherical in the spherical environment shaders.
+        float phi = 2.0f * Pi * (1.0f - (x + 0.5f) / width);
+        cosPhi[x] = cosf(phi);
+        sinPhi[x] = sinf(phi);
+    }
+
+    size_t rowBytes = size_t(width) * 4 * sizeof(float);
+    size_t fixedBytes = faceTexels * 6 * 4 * sizeof(float) + size_t(width) * 2 * sizeof(float) +
+                        (sampled.rowStart.size() + sampled.texels.size()) * sizeof(uint32_t) + rowBytes;
+    size_t bandRowBytes = rowBytes + source.mappedRowBytes();
+    size_t bandRows = memoryBudget > fixedBytes ? (memoryBudget - fixedBytes) / bandRowBytes : 1;
+    bandRows = std::max(size_t(1), std::min(bandRows, size_t(height)));
+    if (fixedBytes + bandRowBytes > memoryBudget)
+    {
+        LOG ("A " << cubeResolution << " cube does not fit the source memory budget, using single row bands");
+    }
+    std::vector<float> band(bandRows * width * 4);
+
+    // The last row of the previous band, for texels sampled across the band edge.
+    std::vector<float> previousRow(size_t(width) * 4);
+
+    for (uint32_t row = 0; row < height; row += uint32_t(bandRows))
+    {
+        if (state.cancelled())
+        {
+            return false;
+        }
+
+        uint32_t rowCount = std::min(uint32_t(bandRows), height - row);
+        IBL_TRACE_NAMED_SCOPE(bandScope, "Resample band", "load");
+        IBL_TRACE_ARG(bandScope, 0, "rows", rowCount);
+        if (!source.readRows(row, rowCount, &band[0]))
+        {
+            LOG ("Failed to read source rows " << row << " to " << row + rowCount);
+            return false;
+        }
+
+        // Nothing to splat into once every texel samples the source.
+        for (uint32_t bandRow = 0; splats && bandRow < rowCount; bandRow++)
+        {
+            float theta = Pi * (row + bandRow + 0.5f) / height;
+            float sinTheta = sinf(theta);
+            float cosTheta = cosf(theta);
+
+            const float* texel = &band[size_t(bandRow) * width * 4];
+            for (uint32_t x = 0; x < width; x++, texel += 4)
+            {
+                uint32_t face, s, t;
+                cubeTexel(sinTheta * cosPhi[x], cosTheta, sinTheta * sinPhi[x], cubeResolution, face, s, t);
+
+                // Equirect texels shrink towards the poles, weight by solid angle.
+                float* target = cubeMap.texels(face, 0) + (size_t(t) * cubeResolution + s) * 4;
+                if (target[3] < 0.0f)
+                {
+                    continue;
+                }
+                target[0] += texel[0] * sinTheta;
+                target[1] += texel[1] * sinTheta;
+                target[2] += texel[2] * sinTheta;
+                target[3] += sinTheta;
+            }
+        }
+
+        // Texels that sample the source write only themselves, they can go in parallel
+        // once there are enough of them to pay for starting the threads.
+        uint32_t firstSample = sampled.rowStart[row];
+        uint32_t sampleCount = sampled.rowStart[row + rowCount] - firstSample;
+        auto sampleBand = [&](uint32_t begin, uint32_t end)
+        {
+            for (uint32_t sampleId = firstSample + begin; sampleId < firstSample + end; sampleId++)
+            {
+                uint32_t texelId = sampled.texels[sampleId];
+                uint32_t face = texelId / uint32_t(faceTexels);
+                uint32_t s = texelId % cubeResolution;
+                uint32_t t = (texelId / cubeResolution) % cubeResolution;
+                float column, sourceRow;
+                equirectPosition(face, s, t, cubeResolution, width, height, column, sourceRow);
+
+                // Rows clamp at the poles, columns wrap around.
+                uint32_t bandRow = std::min(std::max(bottomRow(sourceRow, height), row), row + rowCount - 1) - row;
+                const float* bottom = &band[size_t(bandRow) * width * 4];
+                const float* top = bandRow > 0 ? bottom - size_t(width) * 4 :
+                                   row > 0 ? &previousRow[0] : bottom;
+                float rowWeight = std::max(0.0f, std::min(1.0f, sourceRow + 1.0f - float(row + bandRow)));
+                float columnFloor = floorf(column);
+                float columnWeight = column - columnFloor;
+                int32_t left = int32_t(columnFloor) % int32_t(width);
+                left = left < 0 ? left + int32_t(width) : left;
+                uint32_t right = (uint32_t(left) + 1) % width;
+
+                float* target = cubeMap.texels(face, 0) + (size_t(t) * cubeResolution + s) * 4;
+                for (uint32_t channel = 0; channel < 3; channel++)
+                {
+                    float upper = top[left * 4 + channel] * (1.0f - columnWeight) + top[right * 4 + channel] * columnWeight;
+                    float lower = bottom[left * 4 + channel] * (1.0f - columnWeight) + bottom[right * 4 + channel] * columnWeight;
+                    target[channel] = upper * (1.0f - rowWeight) + lower * rowWeight;
+                }
+            }
+        };
+        if (sampleCount >= SampleParallelTexels)
+        {
+            parallelFor(sampleCount, sampleBand);
+        }
+        else
+        {
+            sampleBand(0, sampleCount);
+        }
+        std::copy(band.begin() + size_t(rowCount - 1) * width * 4, band.begin() + size_t(rowCount) * width * 4,
+                  previousRow.begin());
+
+        source.releaseRows(row, rowCount);
+        state.setProgress(0.95f * float(row + rowCount) / float(height));
+    }
+
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        float* texels = cubeMap.texels(face, 0);
+        for (size_t texel = 0; texel < faceTexels; texel++)
+        {
+            float* target = &texels[texel * 4];
+            if (target[3] > 0.0f)
+            {
+                target[0] /= target[3];
+                target[1] /= target[3];
+                target[2] /= target[3];
+            }
+        }
+
+        fillHoles(texels, cubeResolution);
+        for (size_t texel = 0; texel < faceTexels; texel++)
+        {
+            texels[texel * 4 + 3] = 1.0f;
+        }
+    }
+    state.setProgress(1.0f);
+    return true;
+}
+}
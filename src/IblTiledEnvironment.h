@@ -0,0 +1,148 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_TILED_ENVIRONMENT
+#define INCLUDED_IBL_TILED_ENVIRONMENT
+
+#include <IblPlatform.h>
+
+namespace Ctr
+{
+class AsyncLoadState;
+class CubeMap;
+class DdsView;
+class RadianceReader;
+
+//------------------------------------------------------------------------------------//
+// Rows of a float equirectangular image, top row first.                             //
+//------------------------------------------------------------------------------------//
+class EquirectRowSource
+{
+  public:
+    virtual ~EquirectRowSource() {}
+
+    virtual uint32_t           width() const = 0;
+    virtual uint32_t           height() const = 0;
+
+    // RGBA32F, rowCount * width texels.
+    virtual bool               readRows(uint32_t firstRow, uint32_t rowCount, float* rgba) = 0;
+
+    // Called once rows have been consumed and will not be read again.
+    virtual void               releaseRows(uint32_t firstRow, uint32_t rowCount) {}
+
+    // Bytes of a mapped file a row read keeps resident until it is released. They
+    // count against the memory budget along with the band.
+    virtual size_t             mappedRowBytes() const { return 0; }
+};
+
+// Rows straight from a mapped radiance file.
+class RadianceRowSource : public EquirectRowSource
+{
+  public:
+    RadianceRowSource(const RadianceReader& reader);
+
+    uint32_t                   width() const;
+    uint32_t                   height() const;
+    bool                       readRows(uint32_t firstRow, uint32_t rowCount, float* rgba);
+    void                       releaseRows(uint32_t firstRow, uint32_t rowCount);
+    size_t                     mappedRowBytes() const;
+
+  private:
+    const RadianceReader&      _reader;
+};
+
+// Rows of a mapped RGBA16F or RGBA32F 2D dds.
+class DdsRowSource : public EquirectRowSource
+{
+  public:
+    DdsRowSource(const DdsView& view);
+
+    uint32_t                   width() const;
+    uint32_t                   height() const;
+    bool                       readRows(uint32_t firstRow, uint32_t rowCount, float* rgba);
+    void                       releaseRows(uint32_t firstRow, uint32_t rowCount);
+    size_t                     mappedRowBytes() const;
+
+  private:
+    const uint8_t*             rows(uint32_t firstRow) const;
+
+    const DdsView&             _view;
+};
+
+// Rows of an RGBA32F equirect the caller already has in memory, not copied.
+class MemoryRowSource : public EquirectRowSource
+{
+  public:
+    MemoryRowSource(const float* rgba, uint32_t width, uint32_t height);
+
+    uint32_t                   width() const;
+    uint32_t                   height() const;
+    bool                       readRows(uint32_t firstRow, uint32_t rowCount, float* rgba);
+
+  private:
+    const float*               _rgba;
+    uint32_t                   _width;
+    uint32_t                   _height;
+};
+
+//------------------------------------------------------------------------------------//
+// Converts an equirect that is too big to hold in memory into a cube map at the      //
+// probe's source resolution. The source is read once, top to bottom, one band at     //
+// a time. Each source texel is added to the cube texel it lands in, weighted by      //
+// its solid angle. Cube texels too small to be sure of a source texel, where the     //
+// source is no finer than the cube, sample it bilinearly instead. Only the cube and  //
+// one band are in memory at any time, and the band is sized so the two stay under    //
+// memoryBudget.                                                                      //
+//------------------------------------------------------------------------------------//
+bool                           writeTiledCubeEnvironment(EquirectRowSource& source,
+                                                         const std::string& targetPathName,
+                                                         uint32_t cubeResolution,
+                                                         size_t memoryBudget,
+                                                         AsyncLoadState& state);
+
+// The same resampling into mip 0 of a cube that has already been created.
+bool                           resampleEquirectToCube(EquirectRowSource& source,
+                                                      CubeMap& cubeMap,
+                                                      size_t memoryBudget,
+                                                      AsyncLoadState& state);
+}
+
+#endif
@@ -0,0 +1,323 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblTrace.h>
+#include <IblFileSystem.h>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <math.h>
+
+namespace Ctr
+{
+namespace
+{
+void
+writeJsonString(std::ostream& stream, const std::string& value)
+{
+    stream << '"';
+    for (char character : value)
+    {
+        switch (character)
+        {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            default:
+                if (uint8_t(character) >= 0x20)
+                    stream << character;
+                break;
+        }
+    }
+    stream << '"';
+}
+}
+
+Trace*
+Trace::trace()
+{
+    static Trace instance;
+    return &instance;
+}
+
+Trace::Trace() :
+    _capturing(false),
+    _captureCount(0),
+    _captureStart(0)
+{
+}
+
+void
+Trace::setDirectory(const std::string& directoryName)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _directoryName = directoryName;
+}
+
+bool
+Trace::enabled() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_directoryName.empty();
+}
+
+bool
+Trace::capturing() const
+{
+    return _capturing.load(std::memory_order_relaxed);
+}
+
+void
+Trace::begin(const std::string& captureName)
+{
+    if (!enabled())
+    {
+        return;
+    }
+    if (capturing())
+    {
+        end();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& buffer : _buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+    _captureName = captureName;
+    _captureStart = now();
+    _capturing = true;
+}
+
+void
+Trace::end()
+{
+    if (!capturing())
+    {
+        return;
+    }
+    _capturing = false;
+
+    std::ostringstream filePathName;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        makeDirectory(_directoryName);
+        filePathName << _directoryName << "/" << _captureName << "." << _captureCount++ << ".json";
+    }
+
+    logTotals(_captureName.c_str());
+    if (write(filePathName.str()))
+    {
+        LOG ("Wrote trace " << filePathName.str());
+    }
+}
+
+void
+Trace::logTotals(const char* heading) const
+{
+    std::map<std::string, std::pair<uint64_t, uint32_t> > totals;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& buffer : _buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            for (const Event& event : buffer->events)
+            {
+                std::pair<uint64_t, uint32_t>& total = totals[event.name];
+                total.first += event.duration;
+                total.second++;
+            }
+        }
+    }
+
+    if (totals.empty())
+    {
+        return;
+    }
+
+    LOG ("Stage totals for " << heading);
+    for (const auto& total : totals)
+    {
+        LOG ("  " << total.first << ": " << double(total.second.first) / 1000.0 << " ms over " << total.second.second << " scopes");
+    }
+}
+
+void
+Trace::setThreadName(const char* threadName)
+{
+    ThreadBuffer*& bound = boundBuffer();
+    if (!bound)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& buffer : _buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            if (!buffer->bound && buffer->threadName == threadName)
+            {
+                buffer->bound = true;
+                bound = buffer.get();
+                return;
+            }
+        }
+    }
+
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->threadName = threadName;
+}
+
+void
+Trace::record(const Event& event)
+{
+    if (!capturing())
+    {
+        return;
+    }
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->events.push_back(event);
+}
+
+uint64_t
+Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Trace::ThreadBuffer*&
+Trace::boundBuffer()
+{
+    // Frees the buffer for another thread of the same name once this one exits.
+    struct Binding
+    {
+        Binding() : buffer(nullptr) {}
+        ~Binding() { if (buffer) buffer->bound = false; }
+
+        ThreadBuffer*          buffer;
+    };
+    static thread_local Binding binding;
+    return binding.buffer;
+}
+
+Trace::ThreadBuffer*
+Trace::threadBuffer()
+{
+    // Buffers live as long as the trace, so a lane outlives its thread.
+    ThreadBuffer*& buffer = boundBuffer();
+    if (!buffer)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+        buffer = _buffers.back().get();
+        buffer->threadId = uint32_t(_buffers.size());
+        buffer->bound = true;
+    }
+    return buffer;
+}
+
+bool
+Trace::write(const std::string& filePathName) const
+{
+    std::ofstream file(filePathName.c_str());
+    if (!file)
+    {
+        LOG ("Failed to open " << filePathName << " for writing");
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& buffer : _buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (!buffer->threadName.empty())
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"args\":{\"name\":";
+            writeJsonString(file, buffer->threadName);
+            file << "}}";
+            first = false;
+        }
+
+        for (const Event& event : buffer->events)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":";
+            writeJsonString(file, event.name);
+            file << ",\"cat\":";
+            writeJsonString(file, event.category);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                 << ",\"ts\":" << (event.start >= _captureStart ? event.start - _captureStart : 0)
+                 << ",\"dur\":" << event.duration;
+            if (event.argNames[0] || event.argNames[1] || event.argNames[2])
+            {
+                file << ",\"args\":{";
+                bool firstArg = true;
+                for (uint32_t arg = 0; arg < 3; arg++)
+                {
+                    if (event.argNames[arg])
+                    {
+                        // Counts stay integers, the default precision would round them.
+                        double value = event.argValues[arg];
+                        file << (firstArg ? "" : ",") << "\"" << event.argNames[arg] << "\":";
+                        if (fabs(value) < 1e15 && value == floor(value))
+                            file << int64_t(value);
+                        else
+                            file << value;
+                        firstArg = false;
+                    }
+                }
+                file << "}";
+            }
+            file << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+    return file.good();
+}
+}
@@ -0,0 +1,179 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#ifndef INCLUDED_IBL_TRACE
+#define INCLUDED_IBL_TRACE
+
+#include <IblPlatform.h>
+#include <atomic>
+#include <mutex>
+
+// Builds without tracing compile every IBL_TRACE_* macro away.
+#ifndef IBL_TRACE
+#define IBL_TRACE 1
+#endif
+
+namespace Ctr
+{
+//------------------------------------------------------------------------------------//
+// Collects scoped timings per thread and writes them as Chrome trace json, which     //
+// chrome://tracing and Perfetto both open. A scope costs one relaxed atomic load      //
+// when no capture is running. While a capture runs, each thread appends to its own    //
+// buffer, so threads only contend when the capture is written out.                    //
+//------------------------------------------------------------------------------------//
+class Trace
+{
+  public:
+    struct Event
+    {
+        const char*            name;
+        const char*            category;
+        uint64_t               start;
+        uint64_t               duration;
+        const char*            argNames[3];
+        double                 argValues[3];
+    };
+
+    static Trace*              trace();
+
+    // Empty disables tracing, otherwise one json per capture is written here.
+    void                       setDirectory(const std::string& directoryName);
+    bool                       enabled() const;
+
+    // Starts a capture, writing out any capture still running.
+    void                       begin(const std::string& captureName);
+    // Writes the running capture and logs its totals.
+    void                       end();
+    // Logs total time per scope name for the running capture so far.
+    void                       logTotals(const char* heading) const;
+
+    bool                       capturing() const;
+
+    // Names the calling thread's lane. A thread that has not recorded yet takes over
+    // the lane of an exited thread of the same name, so threads that come and go,
+    // like parallelFor's workers, do not each add a lane.
+    void                       setThreadName(const char* threadName);
+
+    void                       record(const Event& event);
+
+    // Microseconds on a steady clock.
+    static uint64_t            now();
+
+  private:
+    struct ThreadBuffer
+    {
+        std::mutex             mutex;
+        uint32_t               threadId;
+        std::string            threadName;
+        std::vector<Event>     events;
+        // Whether a running thread records into this buffer.
+        std::atomic<bool>      bound;
+    };
+
+    Trace();
+
+    static ThreadBuffer*&      boundBuffer();
+    ThreadBuffer*              threadBuffer();
+    bool                       write(const std::string& filePathName) const;
+
+    std::atomic<bool>          _capturing;
+    std::string                _directoryName;
+    std::string                _captureName;
+    uint32_t                   _captureCount;
+    uint64_t                   _captureStart;
+
+    mutable std::mutex         _mutex;
+    std::vector<std::unique_ptr<ThreadBuffer> > _buffers;
+};
+
+//------------------------------------------------------------------------------------//
+// Times the enclosing scope. Names and argument names must be string literals.       //
+//------------------------------------------------------------------------------------//
+class TraceScope
+{
+  public:
+    TraceScope(const char* name, const char* category)
+    {
+        _event.name = Trace::trace()->capturing() ? name : nullptr;
+        if (_event.name)
+        {
+            _event.category = category;
+            _event.argNames[0] = _event.argNames[1] = _event.argNames[2] = nullptr;
+            _event.start = Trace::now();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (_event.name)
+        {
+            _event.duration = Trace::now() - _event.start;
+            Trace::trace()->record(_event);
+        }
+    }
+
+    void                       setArg(uint32_t index, const char* argName, double value)
+    {
+        if (_event.name)
+        {
+            _event.argNames[index] = argName;
+            _event.argValues[index] = value;
+        }
+    }
+
+  private:
+    Trace::Event               _event;
+};
+}
+
+#if IBL_TRACE
+#define IBL_TRACE_CONCAT_INNER(a, b) a##b
+#define IBL_TRACE_CONCAT(a, b) IBL_TRACE_CONCAT_INNER(a, b)
+#define IBL_TRACE_SCOPE(name, category) Ctr::TraceScope IBL_TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#define IBL_TRACE_NAMED_SCOPE(variable, name, category) Ctr::TraceScope variable(name, category)
+#define IBL_TRACE_ARG(variable, index, argName, value) variable.setArg(index, argName, double(value))
+#else
+#define IBL_TRACE_SCOPE(name, category)
+#define IBL_TRACE_NAMED_SCOPE(variable, name, category)
+#define IBL_TRACE_ARG(variable, index, argName, value)
+#endif
+
+#endif
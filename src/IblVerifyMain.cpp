@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------------//
+//                                                                                    //
+//    ._____________.____   __________         __                                     //
+//    |   \______   \    |  \______   \_____  |  | __ ___________                     //
+//    |   ||    |  _/    |   |    |  _/\__  \ |  |/ // __ \_  __ \                    //
+//    |   ||    |   \    |___|    |   \ / __ \|    <\  ___/|  | \/                    //
+//    |___||______  /_______ \______  /(____  /__|_ \\___  >__|                       //
+//                \/        \/      \/      \/     \/    \/                           //
+//                                                                                    //
+//    IBLBaker is provided under the MIT License(MIT)                                 //
+//    IBLBaker uses portions of other open source software.                           //
+//    Please review the LICENSE file for further details.                             //
+//                                                                                    //
+//    Copyright(c) 2014 Matt Davidson                                                 //
+//                                                                                    //
+//    Permission is hereby granted, free of charge, to any person obtaining a copy    //
+//    of this software and associated documentation files(the "Software"), to deal    //
+//    in the Software without restriction, including without limitation the rights    //
+//    to use, copy, modify, merge, publish, distribute, sublicense, and / or sell     //
+//    copies of the Software, and to permit persons to whom the Software is           //
+//    furnished to do so, subject to the following conditions :                       //
+//                                                                                    //
+//    1. Redistributions of source code must retain the above copyright notice,       //
+//    this list of conditions and the following disclaimer.                           //
+//    2. Redistributions in binary form must reproduce the above copyright notice,    //
+//    this list of conditions and the following disclaimer in the                     //
+//    documentation and / or other materials provided with the distribution.          //
+//    3. Neither the name of the copyright holder nor the names of its                //
+//    contributors may be used to endorse or promote products derived                 //
+//    from this software without specific prior written permission.                   //
+//                                                                                    //
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR      //
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,        //
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE      //
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER          //
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,   //
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN       //
+//    THE SOFTWARE.                                                                   //
+//                                                                                    //
+//------------------------------------------------------------------------------------//
+
+#include <IblCubeMap.h>
+#include <IblImageCompare.h>
+#include <fstream>
+
+using namespace Ctr;
+
+namespace
+{
+void
+writeReport(std::ofstream& report,
+            const std::string& referencePathName,
+            const std::string& candidatePathName,
+            const std::vector<SurfaceComparison>& comparisons,
+            bool& first)
+{
+    for (const SurfaceComparison& comparison : comparisons)
+    {
+        // Infinity is not json, identical surfaces report null.
+        std::ostringstream logPsnr;
+        if (comparison.error.logPsnr <= 1e30)
+        {
+            logPsnr << comparison.error.logPsnr;
+        }
+        else
+        {
+            logPsnr << "null";
+        }
+        report << (first ? "" : ",\n") <<
+                  "{\"reference\": \"" << referencePathName << "\", " <<
+                  "\"candidate\": \"" << candidatePathName << "\", " <<
+                  "\"face\": " << comparison.face << ", " <<
+                  "\"mip\": " << comparison.mip << ", " <<
+                  "\"rmse\": " << comparison.error.rmse << ", " <<
+                  "\"relativeLuminance\": " << comparison.error.relativeLuminanceError << ", " <<
+                  "\"maxError\": " << comparison.error.maxError << ", " <<
+                  "\"logPsnr\": " << logPsnr.str() << ", " <<
+                  "\"nonFinite\": " << comparison.error.nonFiniteCount << ", " <<
+                  "\"passed\": " << (comparison.passed ? "true" : "false") << "}";
+        first = false;
+    }
+}
+}
+
+// Compares baked cubes against reference bakes, face by face and mip by mip.
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> pathNames;
+    std::string reportPathName;
+    MipTolerances tolerances;
+
+    for (int32_t argId = 1; argId < argc; argId++)
+    {
+        std::string option = argv[argId];
+        bool hasValue = argId + 1 < argc;
+        if (option == "--tolerances" && hasValue)
+        {
+            if (!readMipTolerances(argv[++argId], tolerances))
+            {
+                return 1;
+            }
+        }
+        else if (option == "--out" && hasValue)
+        {
+            reportPathName = argv[++argId];
+        }
+        else if (option.compare(0, 2, "--") == 0)
+        {
+            pathNames.clear();
+            break;
+        }
+        else
+        {
+            pathNames.push_back(option);
+        }
+    }
+
+    if (pathNames.empty() || pathNames.size() % 2 != 0)
+    {
+        LOG ("iblbaker_verify: compare baked cube maps against reference bakes");
+        LOG ("  iblbaker_verify <reference.dds> <candidate.dds> [<reference.dds> <candidate.dds> ...]");
+        LOG ("  --tolerances <xml>  Per mip tolerances, see data/iblVerifyTolerances.xml.");
+        LOG ("  --out <file>        Write every face and mip's errors as json.");
+        return 1;
+    }
+
+    std::ofstream report;
+    if (!reportPathName.empty())
+    {
+        report.open(reportPathName.c_str());
+        report << "{\n\"surfaces\": [\n";
+    }
+
+    bool first = true;
+    uint32_t failures = 0;
+    for (size_t pair = 0; pair < pathNames.size(); pair += 2)
+    {
+        const std::string& referencePathName = pathNames[pair];
+        const std::string& candidatePathName = pathNames[pair + 1];
+
+        CubeMap reference, candidate;
+        std::vector<SurfaceComparison> comparisons;
+        if (!reference.load(referencePathName) ||
+            !candidate.load(candidatePathName) ||
+            !compareCubeMaps(reference, candidate, tolerances, comparisons))
+        {
+            LOG ("FAILED " << candidatePathName << ": could not compare with " << referencePathName);
+            failures++;
+            continue;
+        }
+
+        bool passed = comparisonsPassed(comparisons);
+        LOG ((passed ? "passed " : "FAILED ") << candidatePathName);
+        for (const SurfaceComparison& comparison : comparisons)
+        {
+            LOG ("    face " << comparison.face << " mip " << comparison.mip <<
+                 ": rmse " << comparison.error.rmse <<
+                 ", luminance " << comparison.error.relativeLuminanceError <<
+                 ", max " << comparison.error.maxError <<
+                 ", log psnr " << comparison.error.logPsnr << " dB" <<
+                 (comparison.error.nonFiniteCount ? ", non finite texels" : "") <<
+                 (comparison.passed ? "" : "  <- out of tolerance"));
+        }
+        failures += passed ? 0 : 1;
+
+        if (report.is_open())
+        {
+            writeReport(report, referencePathName, candidatePathName, comparisons, first);
+        }
+    }
+
+    if (report.is_open())
+    {
+        report << "\n]\n}\n";
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -40,19 +40,20 @@
 //------------------------------------------------------------------------------------//
 
 #include <IblApplication.h>
-#include <direct.h>
+#include <IblFileSystem.h>
 
 int main(int argc, char* argv[])
 {
     ApplicationHandle applicationInstance = nullptr;
 
     // Move up one directory to get to the sandbox location.
-    _chdir("../");
+    Ctr::setWorkingDirectory("../");
 #if _WIN32
     applicationInstance = GetModuleHandle(nullptr);
-#else 
-    LOG ("Platform is not yet implemented");
-    assert(0)
+#else
+    // Only the D3D11 device exists, other platforms bake with iblbaker_cli.
+    LOG ("The IBLBaker application needs D3D11, use iblbaker_cli on this platform");
+    return 1;
 #endif
 
     assert (applicationInstance);